@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "src/benchmarker.hpp"
@@ -8,8 +11,15 @@
 #include "src/utils/error_handler.hpp"
 
 void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " [--log-errors] [--schema <schema_name>] <duckdb_file> <output_csv>\n";
+    std::cout << "Usage: " << programName << " [--log-errors] [--algorithms <names>] [--sweep-block-codecs] [--auto-select] [--selection-goals <weights>] [--strip-affixes] [--queries] [--synopses] [--schema <schema_name>] <duckdb_file> <output_csv>\n";
     std::cout << "  --log-errors:      Log errors to stderr instead of throwing exceptions (optional)\n";
+    std::cout << "  --algorithms <names>: Comma separated algorithms to run instead of the default ones, e.g. FSST,Zstd,LZ4Dict (optional)\n";
+    std::cout << "  --sweep-block-codecs: Run the block codecs over block sizes, accelerations, LZ4HC levels, zstd levels and block caches (optional)\n";
+    std::cout << "  --auto-select:     Also run AutoSelect, which picks one of the other algorithms per row group (optional)\n";
+    std::cout << "  --selection-goals <ratio,decompression,random_access>: Weights AutoSelect chooses by, default 1,1,0 (optional)\n";
+    std::cout << "  --strip-affixes:   Also run every algorithm with the prefix and suffix all strings of a row group share stripped (optional)\n";
+    std::cout << "  --queries:         Also run range, per-vector min/max, sort and substring queries on every row group, OrderedDictionary and FMIndex (optional)\n";
+    std::cout << "  --synopses:        Build per-vector zone maps and bloom filters, the --queries predicates skip vectors with them (optional)\n";
     std::cout << "  --schema <name>:   Filter to specific schema name (optional)\n";
     std::cout << "  duckdb_file:       Path to the DuckDB database file\n";
     std::cout << "  output_csv:        Path to the output CSV file\n";
@@ -19,12 +29,55 @@ int main(int argc, char* argv[]) {
     // Parse arguments
     std::vector<std::string> positional_args;
     bool log_errors = false;
+    std::vector<AlgorithType> algorithms = DefaultAlgorithms();
+    bool sweep_block_codecs = false;
+    bool auto_select = false;
+    bool strip_affixes = false;
+    bool run_queries = false;
+    bool build_synopses = false;
+    SelectionGoals selection_goals;
     std::string schema_name = "";
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--log-errors") {
             log_errors = true;
+        } else if (arg == "--algorithms") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --algorithms requires a value\n\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+            algorithms.clear();
+            std::stringstream names(argv[++i]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                AlgorithType algorithm;
+                if (!AlgorithTypeFromString(name, algorithm)) {
+                    std::cerr << "Error: unknown algorithm " << name << "\n\n";
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                algorithms.push_back(algorithm);
+            }
+        } else if (arg == "--sweep-block-codecs") {
+            sweep_block_codecs = true;
+        } else if (arg == "--auto-select") {
+            auto_select = true;
+        } else if (arg == "--selection-goals") {
+            if (i + 1 >= argc ||
+                std::sscanf(argv[++i], "%lf,%lf,%lf", &selection_goals.compression_ratio,
+                            &selection_goals.decompression_speed, &selection_goals.random_access) != 3) {
+                std::cerr << "Error: --selection-goals requires three comma separated weights\n\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--strip-affixes") {
+            strip_affixes = true;
+        } else if (arg == "--queries") {
+            run_queries = true;
+        } else if (arg == "--synopses") {
+            build_synopses = true;
         } else if (arg == "--schema") {
             if (i + 1 < argc) {
                 schema_name = argv[++i];
@@ -57,19 +110,32 @@ int main(int argc, char* argv[]) {
         con.Query("PRAGMA threads=1");
         con.Query("SELECT version()")->GetValue(0,0).Print();
 
-        const BenchmarkConfigMetaData meta = {
+        BenchmarkConfigMetaData meta = {
             2,
             1,
             false,
             false,
-            {
-                AlgorithType::FSST,
-                AlgorithType::FSST12,
-                AlgorithType::OnPair16,
-                AlgorithType::Dictionary,
-                AlgorithType::LZ4
+            algorithms
+        };
+        const auto add_algorithm = [&meta](const AlgorithType algorithm) {
+            if (std::find(meta.algorithms.begin(), meta.algorithms.end(), algorithm) == meta.algorithms.end()) {
+                meta.algorithms.push_back(algorithm);
             }
         };
+        if (sweep_block_codecs) {
+            meta.block_codec_parameters = BlockCodecSweep();
+        }
+        if (run_queries) {
+            add_algorithm(AlgorithType::OrderedDictionary);
+            add_algorithm(AlgorithType::FMIndex);
+        }
+        if (auto_select) {
+            add_algorithm(AlgorithType::AutoSelect);
+        }
+        meta.selection_goals = selection_goals;
+        meta.strip_affixes = strip_affixes;
+        meta.run_queries = run_queries;
+        meta.build_synopses = build_synopses;
         const auto config = GetBenchmarkFromDatabase(con, meta, schema_name);
 
         const auto results = RunExperiment(con, config);
@@ -15,20 +15,15 @@ int main() {
     con.Query("PRAGMA threads=1");
     con.Query("SELECT version()")->GetValue(0,0).Print();
 
+    auto algorithms = DefaultAlgorithms();
+    algorithms.push_back(AlgorithType::OnPair);
+    algorithms.push_back(AlgorithType::OnPairMini10);
     const BenchmarkConfigMetaData meta = {
         5,
         40,
-        {
-            AlgorithType::FSST,
-            // AlgorithType::FSST12,
-            AlgorithType::OnPair,
-            AlgorithType::OnPair16,
-            AlgorithType::OnPairMini10,
-            // AlgorithType::OnPairMini12,
-            // AlgorithType::OnPairMini14,
-            AlgorithType::Dictionary,
-            AlgorithType::LZ4
-        }
+        false,
+        false,
+        algorithms
     };
     const auto config = GetBenchmarkFromDatabase(con, meta);
 
@@ -1,11 +1,7 @@
 #include "duckdb.hpp"
-#include "impl_fsst.hpp"
-#include "impl_fsst12.hpp"
-#include "impl_onpair.hpp"
-#include "impl_onpair16.hpp"
-#include "impl_onpair_mini.hpp"
-#include "impl_dictionary.hpp"
-#include "impl_lz4.hpp"
+#include "factory.hpp"
+#include "impl_auto_select.hpp"
+#include "impl_affix_stripping.hpp"
 #include "../models/compression_result.hpp"
 #include "../models/string_collection.hpp"
 
@@ -21,54 +17,26 @@ inline std::vector<idx_t> GenerateRandomIndices(size_t n, size_t max) {
 }
 
 
+// strip_affixes runs the algorithm on the strings without the prefix and suffix they all share
 inline AlgorithmResult Compress(const AlgorithType algorithm, const ExperimentInput &input,
-                                const size_t n_times) {
+                                const size_t n_times, const BlockCodecParameters &block_codec_parameters = {},
+                                const bool strip_affixes = false) {
     std::vector<AlgorithmResult> results(n_times + 1);
 
-    OnPairAlgorithm on_pair;
-    OnPair16Algorithm on_pair16;
-    OnPairMiniAlgorithm<10> on_pair_mini_10;
-    OnPairMiniAlgorithm<12> on_pair_mini_12;
-    OnPairMiniAlgorithm<14> on_pair_mini_14;
-    FsstAlgorithm fsst;
-    Fsst12Algorithm fsst12;
-    DictionaryAlgorithm dictionary;
-    LZ4Algorithm lz4;
-
-
-
-    for (size_t run_idx = 0; run_idx < n_times + 1; run_idx += 1) {
-        switch (algorithm) {
-            case AlgorithType::FSST:
-                results[run_idx] = fsst.Benchmark(input);
-                break;
-            case AlgorithType::FSST12:
-                results[run_idx] = fsst12.Benchmark(input);
-                break;
-            case AlgorithType::OnPair:
-                results[run_idx] = on_pair.Benchmark(input);
-                break;
-            case AlgorithType::OnPair16:
-                results[run_idx] = on_pair16.Benchmark(input);
-                break;
-            case AlgorithType::OnPairMini10:
-                results[run_idx] = on_pair_mini_10.Benchmark(input);
-                break;
-            case AlgorithType::OnPairMini12:
-                results[run_idx] = on_pair_mini_12.Benchmark(input);
-                break;
-            case AlgorithType::OnPairMini14:
-                results[run_idx] = on_pair_mini_14.Benchmark(input);
-                break;
-            case AlgorithType::Dictionary:
-                results[run_idx] = dictionary.Benchmark(input);
-                break;
-            case AlgorithType::LZ4:
-                results[run_idx] = lz4.Benchmark(input);
-                break;
-            default:
-                throw duckdb::Exception(duckdb::ExceptionType::INTERNAL, "Not know!");
+    const auto create = [algorithm, block_codec_parameters]() -> std::unique_ptr<ICompressionAlgorithm> {
+        if (algorithm == AlgorithType::AutoSelect) {
+            return std::make_unique<AutoSelectAlgorithm>(block_codec_parameters);
         }
+        return CreateAlgorithm(algorithm, block_codec_parameters);
+    };
+    std::unique_ptr<ICompressionAlgorithm> instance;
+    if (strip_affixes) {
+        instance = std::make_unique<AffixStrippingAlgorithm>(create());
+    } else {
+        instance = create();
+    }
+    for (size_t run_idx = 0; run_idx < n_times + 1; run_idx += 1) {
+        results[run_idx] = instance->Benchmark(input);
     }
 
     AlgorithmResult mean_result = MeanTimes(
@@ -76,3 +44,69 @@ inline AlgorithmResult Compress(const AlgorithType algorithm, const ExperimentIn
     );
     return mean_result;
 }
+
+inline bool IsBlockCodec(const AlgorithType algorithm) {
+    switch (algorithm) {
+        case AlgorithType::LZ4:
+        case AlgorithType::LZ4Dict:
+        case AlgorithType::Zstd:
+        case AlgorithType::ZstdRowGroupDict:
+        case AlgorithType::ZstdColumnDict:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the parameters the block codec actually uses, with the ones it ignores reset to their defaults
+inline BlockCodecParameters EffectiveBlockCodecParameters(const AlgorithType algorithm, BlockCodecParameters parameters) {
+    constexpr BlockCodecParameters defaults{};
+    if (parameters.block_bytes > 0) {
+        parameters.block_size = defaults.block_size;
+    }
+    const bool is_lz4 = algorithm == AlgorithType::LZ4 || algorithm == AlgorithType::LZ4Dict;
+    if (!is_lz4) {
+        parameters.hc_level = defaults.hc_level;
+    }
+    const bool is_zstd = algorithm == AlgorithType::Zstd || algorithm == AlgorithType::ZstdRowGroupDict ||
+                         algorithm == AlgorithType::ZstdColumnDict;
+    if (!is_zstd) {
+        parameters.zstd_level = defaults.zstd_level;
+    }
+    if (!is_lz4 || parameters.hc_level > 0) {
+        parameters.acceleration = defaults.acceleration;
+    }
+    if (parameters.cache_blocks <= 1) {
+        // a single cached block is always the one evicted
+        parameters.cache_policy = defaults.cache_policy;
+        parameters.cache_blocks = defaults.cache_blocks;
+        parameters.cache_bytes = defaults.cache_bytes;
+    }
+    return parameters;
+}
+
+// Compresses once per distinct configuration of a block codec, other algorithms have a single configuration
+inline std::vector<AlgorithmResult> CompressSweep(const AlgorithType algorithm, const ExperimentInput &input,
+                                                  const size_t n_times,
+                                                  const std::vector<BlockCodecParameters> &block_codec_sweep,
+                                                  const bool strip_affixes = false) {
+    if (!IsBlockCodec(algorithm)) {
+        // AutoSelect compresses the block codecs it picks with their first configuration
+        return {Compress(algorithm, input, n_times, block_codec_sweep.empty() ? BlockCodecParameters{} : block_codec_sweep.front(),
+                         strip_affixes)};
+    }
+
+    std::vector<BlockCodecParameters> configurations;
+    for (const auto &parameters: block_codec_sweep) {
+        const auto effective = EffectiveBlockCodecParameters(algorithm, parameters);
+        if (std::find(configurations.begin(), configurations.end(), effective) == configurations.end()) {
+            configurations.push_back(effective);
+        }
+    }
+
+    std::vector<AlgorithmResult> results;
+    for (const auto &parameters: configurations) {
+        results.push_back(Compress(algorithm, input, n_times, parameters, strip_affixes));
+    }
+    return results;
+}
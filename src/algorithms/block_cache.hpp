@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../models/benchmark_config.hpp"
+
+// Decompressed blocks of a block codec, so random access decompresses a block again only after it was evicted. Holds
+// up to cache_blocks blocks and no more than cache_bytes decompressed bytes, except that the block inserted last is
+// always kept. Counts hits and misses of all lookups
+class BlockCache {
+public:
+    // decompression buffers are this much larger than their block, like the other decompression buffers
+    static constexpr size_t DECOMPRESSION_SLACK = 32;
+
+    void Initialize(const BlockCodecParameters &parameters, const size_t n_blocks) {
+        policy_ = parameters.cache_policy;
+        capacity_blocks_ = std::max<size_t>(parameters.cache_blocks, 1);
+        capacity_bytes_ = parameters.cache_bytes == 0 ? std::numeric_limits<size_t>::max() : parameters.cache_bytes;
+
+        entries_.clear();
+        free_entries_.clear();
+        entry_of_block_.assign(n_blocks, NO_ENTRY);
+        lru_head_ = NO_ENTRY;
+        lru_tail_ = NO_ENTRY;
+        clock_hand_ = 0;
+        n_cached_ = 0;
+        cached_bytes_ = 0;
+        counters_ = {};
+    }
+
+    // returns the decompressed block, or nullptr if it is not cached
+    inline const uint8_t *Find(const size_t block_idx) {
+        const size_t entry_idx = entry_of_block_[block_idx];
+        if (entry_idx == NO_ENTRY) {
+            counters_.misses++;
+            return nullptr;
+        }
+
+        counters_.hits++;
+        Entry &entry = entries_[entry_idx];
+        if (policy_ == BlockCachePolicy::LRU) {
+            Unlink(entry_idx);
+            PushFront(entry_idx);
+        } else {
+            entry.referenced = true;
+        }
+        return entry.data.data();
+    }
+
+    // evicts blocks until one of size bytes fits and returns the buffer to decompress it into, which has a capacity of
+    // size + DECOMPRESSION_SLACK bytes
+    uint8_t *Insert(const size_t block_idx, const size_t size) {
+        while (n_cached_ > 0 && (n_cached_ >= capacity_blocks_ || cached_bytes_ + size > capacity_bytes_)) {
+            Evict(policy_ == BlockCachePolicy::LRU ? lru_tail_ : AdvanceClockHand());
+        }
+
+        size_t entry_idx;
+        if (free_entries_.empty()) {
+            entry_idx = entries_.size();
+            entries_.emplace_back();
+        } else {
+            entry_idx = free_entries_.back();
+            free_entries_.pop_back();
+        }
+
+        Entry &entry = entries_[entry_idx];
+        entry.block_idx = block_idx;
+        entry.size = size;
+        entry.in_use = true;
+        entry.referenced = true;
+        entry.data.resize(size + DECOMPRESSION_SLACK);
+        if (policy_ == BlockCachePolicy::LRU) {
+            PushFront(entry_idx);
+        }
+
+        entry_of_block_[block_idx] = entry_idx;
+        n_cached_++;
+        cached_bytes_ += size;
+        return entry.data.data();
+    }
+
+    [[nodiscard]] BlockCacheCounters GetCounters() const {
+        return counters_;
+    }
+
+    // evicts all blocks, the counters stay
+    void Clear() {
+        entries_.clear();
+        free_entries_.clear();
+        std::fill(entry_of_block_.begin(), entry_of_block_.end(), NO_ENTRY);
+        lru_head_ = NO_ENTRY;
+        lru_tail_ = NO_ENTRY;
+        clock_hand_ = 0;
+        n_cached_ = 0;
+        cached_bytes_ = 0;
+    }
+
+    // releases the memory of the cached blocks, the counters stay
+    void Free() {
+        entries_ = {};
+        free_entries_ = {};
+        entry_of_block_ = {};
+        n_cached_ = 0;
+        cached_bytes_ = 0;
+    }
+
+private:
+    static constexpr size_t NO_ENTRY = std::numeric_limits<size_t>::max();
+
+    struct Entry {
+        size_t block_idx;
+        size_t size;
+        bool in_use;
+        // CLOCK: looked up since the clock hand last passed
+        bool referenced;
+        // LRU: neighbours in the recency list, the head is the most recently used
+        size_t prev;
+        size_t next;
+        std::vector<uint8_t> data;
+    };
+
+    void Evict(const size_t entry_idx) {
+        Entry &entry = entries_[entry_idx];
+        if (policy_ == BlockCachePolicy::LRU) {
+            Unlink(entry_idx);
+        }
+        entry_of_block_[entry.block_idx] = NO_ENTRY;
+        entry.in_use = false;
+        n_cached_--;
+        cached_bytes_ -= entry.size;
+        free_entries_.push_back(entry_idx);
+    }
+
+    // gives every referenced block a second chance, returns the first cached block that was not referenced
+    size_t AdvanceClockHand() {
+        while (true) {
+            const size_t entry_idx = clock_hand_;
+            clock_hand_ = (clock_hand_ + 1) % entries_.size();
+
+            Entry &entry = entries_[entry_idx];
+            if (!entry.in_use) {
+                continue;
+            }
+            if (!entry.referenced) {
+                return entry_idx;
+            }
+            entry.referenced = false;
+        }
+    }
+
+    void PushFront(const size_t entry_idx) {
+        Entry &entry = entries_[entry_idx];
+        entry.prev = NO_ENTRY;
+        entry.next = lru_head_;
+        if (lru_head_ != NO_ENTRY) {
+            entries_[lru_head_].prev = entry_idx;
+        } else {
+            lru_tail_ = entry_idx;
+        }
+        lru_head_ = entry_idx;
+    }
+
+    void Unlink(const size_t entry_idx) {
+        const Entry &entry = entries_[entry_idx];
+        if (entry.prev != NO_ENTRY) {
+            entries_[entry.prev].next = entry.next;
+        } else {
+            lru_head_ = entry.next;
+        }
+        if (entry.next != NO_ENTRY) {
+            entries_[entry.next].prev = entry.prev;
+        } else {
+            lru_tail_ = entry.prev;
+        }
+    }
+
+    BlockCachePolicy policy_{BlockCachePolicy::LRU};
+    size_t capacity_blocks_{1};
+    size_t capacity_bytes_{std::numeric_limits<size_t>::max()};
+
+    std::vector<Entry> entries_;
+    // entries of evicted blocks, reused before new entries are added
+    std::vector<size_t> free_entries_;
+    std::vector<size_t> entry_of_block_;
+
+    size_t lru_head_{NO_ENTRY};
+    size_t lru_tail_{NO_ENTRY};
+    size_t clock_hand_{0};
+
+    size_t n_cached_{0};
+    size_t cached_bytes_{0};
+    BlockCacheCounters counters_{};
+};
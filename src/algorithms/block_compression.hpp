@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "interface.hpp"
+#include "block_cache.hpp"
+
+// Start offsets of the strings of a block within the decompressed block, plus the end of the last string, so a string
+// is located in O(1). Every group of OFFSET_INDEX_GROUP_SIZE strings has a 32-bit base and every string a 16-bit
+// offset relative to the base of its group. Blocks with a group spanning more than 64 KB fall back to 32-bit offsets
+struct StringOffsetIndex {
+    static constexpr size_t OFFSET_INDEX_GROUP_SIZE = 64;
+
+    std::vector<uint32_t> group_bases;
+    std::vector<uint16_t> relative_offsets;
+    // only used by blocks with a group that does not fit 16-bit offsets
+    std::vector<uint32_t> wide_offsets;
+
+    void Build(const std::vector<uint32_t> &lengths) {
+        group_bases.clear();
+        relative_offsets.resize(lengths.size() + 1);
+        wide_offsets.clear();
+
+        uint32_t offset = 0;
+        for (size_t i = 0; i <= lengths.size(); i++) {
+            if (i % OFFSET_INDEX_GROUP_SIZE == 0) {
+                group_bases.push_back(offset);
+            }
+            const uint32_t relative_offset = offset - group_bases.back();
+            if (relative_offset > std::numeric_limits<uint16_t>::max()) {
+                BuildWide(lengths);
+                return;
+            }
+            relative_offsets[i] = static_cast<uint16_t>(relative_offset);
+            if (i < lengths.size()) {
+                offset += lengths[i];
+            }
+        }
+    }
+
+    [[nodiscard]] inline uint32_t Offset(const size_t string_idx) const {
+        if (!wide_offsets.empty()) {
+            return wide_offsets[string_idx];
+        }
+        return group_bases[string_idx / OFFSET_INDEX_GROUP_SIZE] + relative_offsets[string_idx];
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        if (!wide_offsets.empty()) {
+            return wide_offsets.size() * sizeof(uint32_t);
+        }
+        return group_bases.size() * sizeof(uint32_t) + relative_offsets.size() * sizeof(uint16_t);
+    }
+
+private:
+    void BuildWide(const std::vector<uint32_t> &lengths) {
+        group_bases.clear();
+        relative_offsets.clear();
+        wide_offsets.resize(lengths.size() + 1);
+        wide_offsets[0] = 0;
+        for (size_t i = 0; i < lengths.size(); i++) {
+            wide_offsets[i + 1] = wide_offsets[i] + lengths[i];
+        }
+    }
+};
+
+struct Block {
+    // replaces the string lengths, which follow from the offsets
+    StringOffsetIndex string_offsets;
+    size_t uncompressed_data_size;
+    size_t compressed_data_size;
+    uint8_t* compressed_data;
+
+    [[nodiscard]] size_t GetCompressedSize() const {
+        return GetCompressedSizeData() + GetCompressedSizeLengths();
+    }
+
+    [[nodiscard]] size_t GetCompressedSizeData() const {
+        return compressed_data_size;
+    }
+
+    [[nodiscard]] size_t GetCompressedSizeLengths() const {
+        return string_offsets.SizeInBytes();
+    }
+};
+
+// Base for general-purpose codecs that compress the concatenated strings in independent blocks, of a fixed number of
+// strings or of about a target number of bytes. Random access decompresses the block holding the row into the block
+// cache, following rows of cached blocks are served from it. Derived codecs only compress and decompress single blocks
+class BlockCompressionAlgorithm : public ICompressionAlgorithm {
+public:
+    explicit BlockCompressionAlgorithm(const BlockCodecParameters &parameters = {}) : parameters_(parameters) {
+        parameters_.block_size = std::max<size_t>(parameters_.block_size, 1);
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        SplitIntoBlocks(input.collector);
+        const size_t n_blocks = block_row_starts_.size() - 1;
+        blocks_.resize(n_blocks);
+
+        // Allocate the compression buffer with 2x the size of the input data. Add factor 1.5 as we do blocking and not
+        // compress the full data at once
+        const auto total_input_size = static_cast<size_t>(static_cast<double>(input.collector.TotalBytes()) * 1.5 + 256);
+        compression_buffer_size = CompressBound(total_input_size);
+        compression_buffer = static_cast<uint8_t *>(malloc(compression_buffer_size));
+
+        block_cache_.Initialize(parameters_, n_blocks);
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        // without training, compressing the blocks is all encoding
+        auto timer = TimePhase(CompressionPhase::Encode);
+        CompressBlocks(data);
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        uint8_t* write_ptr = out;
+        size_t remaining_capacity = out_capacity;
+
+        for (const auto &block: blocks_) {
+            const size_t decompressed_size = DecompressBlock(block, write_ptr, remaining_capacity);
+            if (decompressed_size != block.uncompressed_data_size) {
+                ErrorHandler::HandleRuntimeError(ToString(GetAlgorithmType()) + " decompression output size mismatch");
+            }
+
+            write_ptr += decompressed_size;
+            remaining_capacity -= decompressed_size;
+        }
+    }
+
+    // returns the decompressed block, decompressing it into the block cache if it is not cached
+    inline const uint8_t *DecompressAndCacheBlock(const idx_t block_idx) {
+        const uint8_t *cached_block = block_cache_.Find(block_idx);
+        if (cached_block != nullptr) {
+            return cached_block;
+        }
+
+        const auto &block = blocks_[block_idx];
+        uint8_t *decompressed_block = block_cache_.Insert(block_idx, block.uncompressed_data_size);
+        const size_t decompressed_size = DecompressBlock(block, decompressed_block,
+                                                         block.uncompressed_data_size + BlockCache::DECOMPRESSION_SLACK);
+        if (decompressed_size != block.uncompressed_data_size) {
+            ErrorHandler::HandleRuntimeError(ToString(GetAlgorithmType()) + " decompression output size mismatch");
+        }
+        return decompressed_block;
+    }
+
+    inline idx_t DecompressOne(const size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        const size_t block_idx = FindBlock(index);
+        const uint8_t *decompressed_block = DecompressAndCacheBlock(block_idx);
+        const Block &block = blocks_[block_idx];
+
+        const size_t string_idx_in_block = index - block_row_starts_[block_idx];
+        const size_t string_offset = block.string_offsets.Offset(string_idx_in_block);
+        const size_t string_length = block.string_offsets.Offset(string_idx_in_block + 1) - string_offset;
+
+        // copy the string to the output buffer
+        if (string_length > out_capacity) {
+            ErrorHandler::HandleRuntimeError("Output buffer too small for decompressed string");
+        }
+
+        std::memcpy(out, decompressed_block + string_offset, string_length);
+
+        return string_length;
+    }
+
+    // a view into the cached block, valid until the block is evicted, so at least until the next call. A view of all
+    // rows would need all blocks cached, which the cache is not meant to hold
+    bool DecompressOneView(const size_t index, std::string_view &view) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOneView called before CompressAll/Benchmark");
+
+        const size_t block_idx = FindBlock(index);
+        const uint8_t *decompressed_block = DecompressAndCacheBlock(block_idx);
+        const Block &block = blocks_[block_idx];
+
+        const size_t string_idx_in_block = index - block_row_starts_[block_idx];
+        const size_t string_offset = block.string_offsets.Offset(string_idx_in_block);
+        const size_t string_length = block.string_offsets.Offset(string_idx_in_block + 1) - string_offset;
+        view = std::string_view(reinterpret_cast<const char *>(decompressed_block) + string_offset, string_length);
+        return true;
+    }
+
+    [[nodiscard]] BlockCacheCounters GetBlockCacheCounters() const override {
+        return block_cache_.GetCounters();
+    }
+
+    void ResetDecompressionCaches() override {
+        block_cache_.Clear();
+    }
+
+    void Free() override {
+        free(compression_buffer);
+        compression_buffer = nullptr;
+        compression_buffer_size = 0;
+
+        block_cache_.Free();
+    }
+
+protected:
+    // upper bound of the compressed size of input_size bytes
+    [[nodiscard]] virtual size_t CompressBound(size_t input_size) const = 0;
+
+    // compresses a block into out and returns the compressed size
+    virtual size_t CompressBlock(const uint8_t *in, size_t in_size, uint8_t *out, size_t out_capacity) = 0;
+
+    // decompresses a block into out and returns the decompressed size
+    virtual size_t DecompressBlock(const Block &block, uint8_t *out, size_t out_capacity) = 0;
+
+    void CompressBlocks(const StringCollector &data) {
+        const auto pointers = data.GetPointers();
+
+        uint8_t* write_ptr = compression_buffer;
+        std::vector<uint32_t> lengths;
+
+        for (size_t block_idx = 0; block_idx < blocks_.size(); block_idx++) {
+
+            auto &block = blocks_[block_idx];
+
+            const size_t string_start_idx = block_row_starts_[block_idx];
+            const size_t string_end_idx = block_row_starts_[block_idx + 1];
+
+            const uint8_t* input_ptr = pointers[string_start_idx];
+
+            size_t input_size = 0;
+            lengths.resize(string_end_idx - string_start_idx);
+            for (size_t i = string_start_idx; i < string_end_idx; i++) {
+                const size_t length = data.GetLength(i);
+                input_size += length;
+                lengths[i - string_start_idx] = static_cast<uint32_t>(length);
+            }
+            block.string_offsets.Build(lengths);
+
+            const size_t max_output_size = compression_buffer_size - (write_ptr - compression_buffer);
+            const size_t compressed_size = CompressBlock(input_ptr, input_size, write_ptr, max_output_size);
+
+            block.uncompressed_data_size = input_size;
+            block.compressed_data = write_ptr;
+            block.compressed_data_size = compressed_size;
+            write_ptr += compressed_size;
+        }
+
+        compressed_ready_ = true;
+    }
+
+    void SplitIntoBlocks(const StringCollector &data) {
+        block_row_starts_.clear();
+        if (parameters_.block_bytes == 0) {
+            for (size_t row = 0; row < data.Size(); row += parameters_.block_size) {
+                block_row_starts_.push_back(row);
+            }
+        } else {
+            size_t block_bytes = parameters_.block_bytes;
+            for (size_t row = 0; row < data.Size(); row++) {
+                if (block_bytes >= parameters_.block_bytes) {
+                    block_row_starts_.push_back(row);
+                    block_bytes = 0;
+                }
+                block_bytes += data.GetLength(row);
+            }
+        }
+        block_row_starts_.push_back(data.Size());
+    }
+
+    [[nodiscard]] inline size_t FindBlock(const size_t row) const {
+        if (parameters_.block_bytes == 0) {
+            return row / parameters_.block_size;
+        }
+        const auto next_block = std::upper_bound(block_row_starts_.begin(), block_row_starts_.end(), row);
+        return next_block - block_row_starts_.begin() - 1;
+    }
+
+    // sums up the compressed data and the string offset indexes of all blocks
+    void CalcBlocksCompressedSize(size_t &compressed_size_data, size_t &compressed_size_lengths) const {
+        compressed_size_data = 0;
+        compressed_size_lengths = 0;
+        for (const auto &block: blocks_) {
+            compressed_size_data += block.GetCompressedSizeData();
+            compressed_size_lengths += block.GetCompressedSizeLengths();
+        }
+    }
+
+    // e.g. "block_size=2048" or "block_size=2048;cache=lru;cache_blocks=16", to be extended by the derived codecs
+    [[nodiscard]] std::string GetBlockParameters() const {
+        std::string block_parameters = parameters_.block_bytes > 0
+                                           ? "block_bytes=" + std::to_string(parameters_.block_bytes)
+                                           : "block_size=" + std::to_string(parameters_.block_size);
+        if (parameters_.cache_blocks > 1) {
+            block_parameters += ";cache=" + ToString(parameters_.cache_policy) +
+                    ";cache_blocks=" + std::to_string(parameters_.cache_blocks);
+            if (parameters_.cache_bytes > 0) {
+                block_parameters += ";cache_bytes=" + std::to_string(parameters_.cache_bytes);
+            }
+        }
+        return block_parameters;
+    }
+
+    BlockCodecParameters parameters_;
+    bool compressed_ready_{false};
+    // first row of every block, followed by the number of rows
+    std::vector<size_t> block_row_starts_;
+    std::vector<Block> blocks_;
+
+    // buffer for the compressed data
+    idx_t compression_buffer_size;
+    uint8_t *compression_buffer;
+
+    // decompressed blocks for random access decompression
+    BlockCache block_cache_;
+};
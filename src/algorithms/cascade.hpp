@@ -0,0 +1,525 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fsst/fsst.h"
+#include "../models/benchmark_config.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Building blocks of the cascading compression of CascadeAlgorithm: a string column is split by a string scheme into
+// strings and integer streams, which are compressed further by the next level of the cascade
+
+enum class IntegerScheme {
+    Bitpacking, // the values bitpacked
+    FOR, // frame of reference: the difference to the minimum bitpacked
+    RLE, // run values and run ends, both compressed as integer streams again
+};
+
+enum class StringScheme {
+    Raw, // the string bytes and their lengths
+    Dictionary, // the unique strings and a code per string
+    RLE, // a string per run and the run ends
+    FSST, // the FSST compressed string bytes and their lengths
+};
+
+// A compressed stream of integers
+struct CascadeIntegers {
+    IntegerScheme scheme{IntegerScheme::Bitpacking};
+    size_t n{0};
+
+    // Bitpacking and FOR
+    uint32_t base{0};
+    uint8_t bits{1};
+    std::vector<uint8_t> packed;
+
+    // RLE: the value and the end (exclusive) of every run
+    std::unique_ptr<CascadeIntegers> run_values;
+    std::unique_ptr<CascadeIntegers> run_ends;
+
+    [[nodiscard]] inline uint32_t Get(const size_t index) const {
+        if (scheme == IntegerScheme::RLE) {
+            return run_values->Get(run_ends->UpperBound(index));
+        }
+        return base + static_cast<uint32_t>(BitPackingUtils::Unpack(packed.data(), bits, index));
+    }
+
+    // index of the first value larger than value, the values have to be ascending
+    [[nodiscard]] inline size_t UpperBound(const size_t value) const {
+        size_t low = 0;
+        size_t high = n;
+        while (low < high) {
+            const size_t mid = (low + high) / 2;
+            if (Get(mid) <= value) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // decodes the values from start to start + count, RLE searches the run of start only once
+    void DecodeRange(const size_t start, const size_t count, uint32_t *out) const {
+        if (scheme != IntegerScheme::RLE) {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = base + static_cast<uint32_t>(BitPackingUtils::Unpack(packed.data(), bits, start + i));
+            }
+            return;
+        }
+
+        size_t run_idx = run_ends->UpperBound(start);
+        size_t run_end = count > 0 ? run_ends->Get(run_idx) : 0;
+        uint32_t value = count > 0 ? run_values->Get(run_idx) : 0;
+        for (size_t i = 0; i < count; i++) {
+            if (start + i == run_end) {
+                run_idx++;
+                run_end = run_ends->Get(run_idx);
+                value = run_values->Get(run_idx);
+            }
+            out[i] = value;
+        }
+    }
+
+    void DecodeAll(uint32_t *out) const {
+        if (scheme != IntegerScheme::RLE) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = base + static_cast<uint32_t>(BitPackingUtils::Unpack(packed.data(), bits, i));
+            }
+            return;
+        }
+
+        std::vector<uint32_t> values(run_values->n);
+        std::vector<uint32_t> ends(run_ends->n);
+        run_values->DecodeAll(values.data());
+        run_ends->DecodeAll(ends.data());
+        uint32_t run_start = 0;
+        for (size_t run_idx = 0; run_idx < values.size(); run_idx++) {
+            std::fill(out + run_start, out + ends[run_idx], values[run_idx]);
+            run_start = ends[run_idx];
+        }
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        switch (scheme) {
+            case IntegerScheme::Bitpacking: return packed.size() - BitPackingUtils::PACKING_PADDING;
+            case IntegerScheme::FOR: return sizeof(base) + packed.size() - BitPackingUtils::PACKING_PADDING;
+            case IntegerScheme::RLE: return run_values->SizeInBytes() + run_ends->SizeInBytes();
+        }
+        return 0;
+    }
+
+    [[nodiscard]] std::string Describe() const {
+        switch (scheme) {
+            case IntegerScheme::Bitpacking: return "bitpack";
+            case IntegerScheme::FOR: return "for";
+            case IntegerScheme::RLE: return "rle(values=" + run_values->Describe() + ",ends=" + run_ends->Describe() + ")";
+        }
+        return "unknown";
+    }
+};
+
+// A compressed column of strings
+struct CascadeStrings {
+    StringScheme scheme{StringScheme::Raw};
+    size_t n{0};
+    // total length of the decompressed strings
+    size_t decoded_size{0};
+
+    // Raw and FSST: the (FSST compressed) string bytes, their lengths and the offset of every CASCADE_OFFSET_SAMPLE-th
+    // string
+    std::vector<uint8_t> bytes;
+    std::unique_ptr<CascadeIntegers> lengths;
+    std::vector<uint32_t> offset_samples;
+    fsst_decoder_t decoder{};
+    size_t symbol_table_size{0};
+
+    // Dictionary: the unique strings and the code of every string. RLE: the string of every run and the run ends
+    std::unique_ptr<CascadeStrings> values;
+    std::unique_ptr<CascadeIntegers> codes;
+
+    // writes the string to out and returns its length
+    inline size_t Get(const size_t index, uint8_t *out, const size_t out_capacity) const {
+        switch (scheme) {
+            case StringScheme::Dictionary: return values->Get(codes->Get(index), out, out_capacity);
+            case StringScheme::RLE: return values->Get(codes->UpperBound(index), out, out_capacity);
+            default: break;
+        }
+
+        // the lengths from the last sampled offset up to the string
+        uint32_t block_lengths[CASCADE_OFFSET_SAMPLE];
+        const size_t n_before = index % CASCADE_OFFSET_SAMPLE;
+        lengths->DecodeRange(index - n_before, n_before + 1, block_lengths);
+        size_t offset = offset_samples[index / CASCADE_OFFSET_SAMPLE];
+        for (size_t i = 0; i < n_before; i++) {
+            offset += block_lengths[i];
+        }
+        const size_t length = block_lengths[n_before];
+        if (scheme == StringScheme::FSST) {
+            return fsst_decompress(&decoder, length, bytes.data() + offset, out_capacity, out);
+        }
+        std::memcpy(out, bytes.data() + offset, length);
+        return length;
+    }
+
+    // writes all strings to out and returns the number of bytes written. If string_lengths is not null, the length of
+    // every string is written to it
+    size_t DecodeAll(uint8_t *out, const size_t out_capacity, uint32_t *string_lengths) const {
+        switch (scheme) {
+            case StringScheme::Raw: {
+                if (string_lengths != nullptr) {
+                    lengths->DecodeAll(string_lengths);
+                }
+                std::memcpy(out, bytes.data(), bytes.size());
+                return bytes.size();
+            }
+            case StringScheme::FSST: {
+                std::vector<uint32_t> encoded_lengths(n);
+                lengths->DecodeAll(encoded_lengths.data());
+                const uint8_t *read_ptr = bytes.data();
+                uint8_t *write_ptr = out;
+                for (size_t i = 0; i < n; i++) {
+                    const size_t length = fsst_decompress(&decoder, encoded_lengths[i], read_ptr,
+                                                          out_capacity - (write_ptr - out), write_ptr);
+                    if (string_lengths != nullptr) {
+                        string_lengths[i] = static_cast<uint32_t>(length);
+                    }
+                    read_ptr += encoded_lengths[i];
+                    write_ptr += length;
+                }
+                return write_ptr - out;
+            }
+            case StringScheme::Dictionary:
+            case StringScheme::RLE: {
+                // decode the values once, then copy them for every string or run
+                std::vector<uint8_t> value_bytes(values->decoded_size + 32);
+                std::vector<uint32_t> value_lengths(values->n);
+                values->DecodeAll(value_bytes.data(), value_bytes.size(), value_lengths.data());
+                std::vector<uint32_t> value_offsets(values->n + 1, 0);
+                for (size_t i = 0; i < values->n; i++) {
+                    value_offsets[i + 1] = value_offsets[i] + value_lengths[i];
+                }
+
+                std::vector<uint32_t> decoded_codes(codes->n);
+                codes->DecodeAll(decoded_codes.data());
+                uint8_t *write_ptr = out;
+                if (scheme == StringScheme::Dictionary) {
+                    for (size_t row = 0; row < n; row++) {
+                        const uint32_t code = decoded_codes[row];
+                        std::memcpy(write_ptr, value_bytes.data() + value_offsets[code], value_lengths[code]);
+                        write_ptr += value_lengths[code];
+                        if (string_lengths != nullptr) {
+                            string_lengths[row] = value_lengths[code];
+                        }
+                    }
+                    return write_ptr - out;
+                }
+
+                // a run is filled by copying its string once and then the filled part again, doubling it every time
+                size_t run_start = 0;
+                for (size_t run_idx = 0; run_idx < decoded_codes.size(); run_idx++) {
+                    const size_t length = value_lengths[run_idx];
+                    const size_t run_length = decoded_codes[run_idx] - run_start;
+                    const size_t total = length * run_length;
+                    if (total > 0) {
+                        std::memcpy(write_ptr, value_bytes.data() + value_offsets[run_idx], length);
+                        for (size_t filled = length; filled < total;) {
+                            const size_t chunk = std::min(filled, total - filled);
+                            std::memcpy(write_ptr + filled, write_ptr, chunk);
+                            filled += chunk;
+                        }
+                    }
+                    if (string_lengths != nullptr) {
+                        std::fill(string_lengths + run_start, string_lengths + decoded_codes[run_idx],
+                                  static_cast<uint32_t>(length));
+                    }
+                    write_ptr += total;
+                    run_start = decoded_codes[run_idx];
+                }
+                return write_ptr - out;
+            }
+        }
+        return 0;
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        switch (scheme) {
+            case StringScheme::Raw:
+            case StringScheme::FSST:
+                return symbol_table_size + bytes.size() + lengths->SizeInBytes() + offset_samples.size() * sizeof(uint32_t);
+            case StringScheme::Dictionary:
+            case StringScheme::RLE:
+                return values->SizeInBytes() + codes->SizeInBytes();
+        }
+        return 0;
+    }
+
+    // the part of the size that does not grow with the number of strings
+    [[nodiscard]] size_t SymbolTablesSize() const {
+        return values ? symbol_table_size + values->SymbolTablesSize() : symbol_table_size;
+    }
+
+    [[nodiscard]] std::string Describe() const {
+        switch (scheme) {
+            case StringScheme::Raw: return "raw(lengths=" + lengths->Describe() + ")";
+            case StringScheme::FSST: return "fsst(lengths=" + lengths->Describe() + ")";
+            case StringScheme::Dictionary:
+                return "dict(entries=" + values->Describe() + ",codes=" + codes->Describe() + ")";
+            case StringScheme::RLE:
+                return "rle(values=" + values->Describe() + ",ends=" + codes->Describe() + ")";
+        }
+        return "unknown";
+    }
+};
+
+// Compresses columns by choosing the scheme of every level of the cascade on a sample: CASCADE_SAMPLE_RUNS runs of
+// CASCADE_SAMPLE_RUN_LENGTH consecutive values, spread evenly over the input, are compressed with every candidate
+class CascadeCompressor {
+public:
+    // time spent choosing schemes, including compressing the samples
+    double selection_ms{0.0};
+
+    std::unique_ptr<CascadeStrings> CompressStrings(const std::vector<std::string_view> &strings, const size_t depth,
+                                                    const bool unique = false) {
+        return CompressStringsWith(ChooseStringScheme(strings, depth, unique), strings, depth);
+    }
+
+    std::unique_ptr<CascadeIntegers> CompressIntegers(const std::vector<uint32_t> &values, const size_t depth) {
+        return CompressIntegersWith(ChooseIntegerScheme(values, depth), values, depth);
+    }
+
+private:
+    // adds the time to selection_ms unless an outer selection is already timed
+    class SelectionTimer {
+    public:
+        explicit SelectionTimer(CascadeCompressor &compressor)
+            : compressor_(compressor), outer_(!compressor.selecting_), start_(std::chrono::high_resolution_clock::now()) {
+            compressor_.selecting_ = true;
+        }
+
+        ~SelectionTimer() {
+            if (!outer_) return;
+            compressor_.selecting_ = false;
+            const auto end = std::chrono::high_resolution_clock::now();
+            compressor_.selection_ms += std::chrono::duration<double, std::milli>(end - start_).count();
+        }
+
+        SelectionTimer(const SelectionTimer &) = delete;
+        SelectionTimer &operator=(const SelectionTimer &) = delete;
+
+    private:
+        CascadeCompressor &compressor_;
+        bool outer_;
+        std::chrono::high_resolution_clock::time_point start_;
+    };
+
+    template <typename T>
+    static std::vector<T> DrawSample(const std::vector<T> &values) {
+        constexpr size_t sample_size = CASCADE_SAMPLE_RUNS * CASCADE_SAMPLE_RUN_LENGTH;
+        if (values.size() <= sample_size) {
+            return values;
+        }
+        std::vector<T> sample;
+        sample.reserve(sample_size);
+        const size_t stride = values.size() / CASCADE_SAMPLE_RUNS;
+        for (size_t run = 0; run < CASCADE_SAMPLE_RUNS; run++) {
+            const auto start = values.begin() + run * stride;
+            sample.insert(sample.end(), start, start + CASCADE_SAMPLE_RUN_LENGTH);
+        }
+        return sample;
+    }
+
+    IntegerScheme ChooseIntegerScheme(const std::vector<uint32_t> &values, const size_t depth) {
+        if (depth <= 1) {
+            // RLE needs another level for its streams, FOR is never larger than bitpacking by more than its base
+            return IntegerScheme::FOR;
+        }
+
+        SelectionTimer timer(*this);
+        const auto sample = DrawSample(values);
+        IntegerScheme best_scheme = IntegerScheme::Bitpacking;
+        size_t best_size = SIZE_MAX;
+        for (const IntegerScheme scheme: {IntegerScheme::Bitpacking, IntegerScheme::FOR, IntegerScheme::RLE}) {
+            const size_t size = CompressIntegersWith(scheme, sample, depth)->SizeInBytes();
+            if (size < best_size) {
+                best_size = size;
+                best_scheme = scheme;
+            }
+        }
+        return best_scheme;
+    }
+
+    std::unique_ptr<CascadeIntegers> CompressIntegersWith(const IntegerScheme scheme, const std::vector<uint32_t> &values,
+                                                          const size_t depth) {
+        auto compressed = std::make_unique<CascadeIntegers>();
+        compressed->scheme = scheme;
+        compressed->n = values.size();
+
+        if (scheme == IntegerScheme::RLE) {
+            std::vector<uint32_t> run_values;
+            std::vector<uint32_t> run_ends;
+            for (size_t i = 0; i < values.size(); i++) {
+                if (!run_values.empty() && run_values.back() == values[i]) {
+                    run_ends.back()++;
+                } else {
+                    run_values.push_back(values[i]);
+                    run_ends.push_back(static_cast<uint32_t>(i + 1));
+                }
+            }
+            compressed->run_values = CompressIntegers(run_values, depth - 1);
+            compressed->run_ends = CompressIntegers(run_ends, depth - 1);
+            return compressed;
+        }
+
+        uint32_t min_value = 0;
+        uint32_t max_value = 0;
+        if (!values.empty()) {
+            const auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+            min_value = *min_it;
+            max_value = *max_it;
+        }
+        compressed->base = scheme == IntegerScheme::FOR ? min_value : 0;
+        compressed->bits = BitPackingUtils::GetBitsPerValue(max_value - compressed->base);
+        if (scheme == IntegerScheme::FOR) {
+            std::vector<uint32_t> differences(values.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                differences[i] = values[i] - compressed->base;
+            }
+            compressed->packed = BitPackingUtils::Pack(differences, compressed->bits);
+        } else {
+            compressed->packed = BitPackingUtils::Pack(values, compressed->bits);
+        }
+        return compressed;
+    }
+
+    StringScheme ChooseStringScheme(const std::vector<std::string_view> &strings, const size_t depth, const bool unique) {
+        SelectionTimer timer(*this);
+        const auto sample = DrawSample(strings);
+        const double scale = sample.empty() ? 1.0 : static_cast<double>(strings.size()) / static_cast<double>(sample.size());
+
+        std::vector<StringScheme> candidates = {StringScheme::Raw, StringScheme::FSST};
+        if (depth > 1 && !unique) {
+            candidates.push_back(StringScheme::Dictionary);
+            candidates.push_back(StringScheme::RLE);
+        }
+
+        StringScheme best_scheme = StringScheme::Raw;
+        double best_size = 0.0;
+        for (const StringScheme scheme: candidates) {
+            const auto compressed = CompressStringsWith(scheme, sample, depth);
+            // symbol tables are stored once, no matter how many strings they encode
+            const auto fixed_size = static_cast<double>(compressed->SymbolTablesSize());
+            const double size = (static_cast<double>(compressed->SizeInBytes()) - fixed_size) * scale + fixed_size;
+            if (scheme == candidates.front() || size < best_size) {
+                best_size = size;
+                best_scheme = scheme;
+            }
+        }
+        return best_scheme;
+    }
+
+    std::unique_ptr<CascadeStrings> CompressStringsWith(const StringScheme scheme,
+                                                        const std::vector<std::string_view> &strings,
+                                                        const size_t depth) {
+        auto compressed = std::make_unique<CascadeStrings>();
+        compressed->scheme = scheme;
+        compressed->n = strings.size();
+        for (const auto &str: strings) {
+            compressed->decoded_size += str.size();
+        }
+        const size_t child_depth = std::max<size_t>(depth - 1, 1);
+
+        switch (scheme) {
+            case StringScheme::Raw: {
+                compressed->bytes.reserve(compressed->decoded_size);
+                std::vector<uint32_t> lengths(strings.size());
+                for (size_t i = 0; i < strings.size(); i++) {
+                    compressed->bytes.insert(compressed->bytes.end(), strings[i].begin(), strings[i].end());
+                    lengths[i] = static_cast<uint32_t>(strings[i].size());
+                }
+                SetLengths(*compressed, lengths, child_depth);
+                break;
+            }
+            case StringScheme::FSST: {
+                std::vector<size_t> lengths(strings.size());
+                std::vector<const unsigned char *> pointers(strings.size());
+                for (size_t i = 0; i < strings.size(); i++) {
+                    lengths[i] = strings[i].size();
+                    pointers[i] = reinterpret_cast<const unsigned char *>(strings[i].data());
+                }
+                fsst_encoder_t *encoder = fsst_create(strings.size(), lengths.data(), pointers.data(), 0);
+                compressed->bytes.resize(compressed->decoded_size * 2 + 1000);
+                std::vector<size_t> encoded_lengths(strings.size());
+                std::vector<unsigned char *> encoded_pointers(strings.size());
+                fsst_compress(encoder, strings.size(), lengths.data(), pointers.data(), compressed->bytes.size(),
+                              compressed->bytes.data(), encoded_lengths.data(), encoded_pointers.data());
+
+                std::vector<uint32_t> stored_lengths(strings.size());
+                size_t encoded_size = 0;
+                for (size_t i = 0; i < strings.size(); i++) {
+                    stored_lengths[i] = static_cast<uint32_t>(encoded_lengths[i]);
+                    encoded_size += encoded_lengths[i];
+                }
+                compressed->bytes.resize(encoded_size);
+
+                uint8_t header_buffer[FSST_MAXHEADER];
+                compressed->symbol_table_size = fsst_export(encoder, header_buffer);
+                compressed->decoder = fsst_decoder(encoder);
+                fsst_destroy(encoder);
+                SetLengths(*compressed, stored_lengths, child_depth);
+                break;
+            }
+            case StringScheme::Dictionary: {
+                robin_hood::unordered_map<std::string_view, uint32_t> dictionary;
+                std::vector<std::string_view> entries;
+                std::vector<uint32_t> codes(strings.size());
+                for (size_t i = 0; i < strings.size(); i++) {
+                    auto [it, inserted] = dictionary.try_emplace(strings[i], static_cast<uint32_t>(entries.size()));
+                    if (inserted) {
+                        entries.push_back(strings[i]);
+                    }
+                    codes[i] = it->second;
+                }
+                compressed->values = CompressStrings(entries, child_depth, true);
+                compressed->codes = CompressIntegers(codes, child_depth);
+                break;
+            }
+            case StringScheme::RLE: {
+                std::vector<std::string_view> run_values;
+                std::vector<uint32_t> run_ends;
+                for (size_t i = 0; i < strings.size(); i++) {
+                    if (!run_values.empty() && run_values.back() == strings[i]) {
+                        run_ends.back()++;
+                    } else {
+                        run_values.push_back(strings[i]);
+                        run_ends.push_back(static_cast<uint32_t>(i + 1));
+                    }
+                }
+                compressed->values = CompressStrings(run_values, child_depth);
+                compressed->codes = CompressIntegers(run_ends, child_depth);
+                break;
+            }
+        }
+        return compressed;
+    }
+
+    void SetLengths(CascadeStrings &compressed, const std::vector<uint32_t> &lengths, const size_t depth) {
+        uint32_t offset = 0;
+        for (size_t i = 0; i < lengths.size(); i++) {
+            if (i % CASCADE_OFFSET_SAMPLE == 0) {
+                compressed.offset_samples.push_back(offset);
+            }
+            offset += lengths[i];
+        }
+        compressed.lengths = CompressIntegers(lengths, depth);
+    }
+
+    bool selecting_{false};
+};
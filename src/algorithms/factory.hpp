@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "duckdb.hpp"
+#include "impl_fsst.hpp"
+#include "impl_fsst12.hpp"
+#include "impl_onpair.hpp"
+#include "impl_onpair16.hpp"
+#include "impl_onpair_mini.hpp"
+#include "impl_dictionary.hpp"
+#include "impl_dictionary_fsst.hpp"
+#include "impl_lz4.hpp"
+#include "impl_zstd.hpp"
+#include "impl_front_coding.hpp"
+#include "impl_rle_dictionary.hpp"
+#include "impl_dictionary_huffman.hpp"
+#include "impl_fsst_huffman.hpp"
+#include "impl_cascade.hpp"
+#include "impl_typed_string.hpp"
+#include "impl_template.hpp"
+#include "impl_fm_index.hpp"
+
+// Creates the algorithm of the given type, the block codecs with the given parameters. Algorithms that choose among
+// the others (AutoSelect) or wrap them (AffixStrippingAlgorithm) are created by the caller
+inline std::unique_ptr<ICompressionAlgorithm> CreateAlgorithm(const AlgorithType algorithm,
+                                                              const BlockCodecParameters &block_codec_parameters = {}) {
+    switch (algorithm) {
+        case AlgorithType::FSST:
+            return std::make_unique<FsstAlgorithm>();
+        case AlgorithType::FSST12:
+            return std::make_unique<Fsst12Algorithm>();
+        case AlgorithType::OnPair:
+            return std::make_unique<OnPairAlgorithm>();
+        case AlgorithType::OnPair16:
+            return std::make_unique<OnPair16Algorithm>();
+        case AlgorithType::OnPairMini10:
+            return std::make_unique<OnPairMiniAlgorithm<10>>();
+        case AlgorithType::OnPairMini12:
+            return std::make_unique<OnPairMiniAlgorithm<12>>();
+        case AlgorithType::OnPairMini14:
+            return std::make_unique<OnPairMiniAlgorithm<14>>();
+        case AlgorithType::Dictionary:
+            return std::make_unique<DictionaryAlgorithm>();
+        case AlgorithType::LZ4:
+            return std::make_unique<LZ4Algorithm>(false, block_codec_parameters);
+        case AlgorithType::FSSTParallel:
+            return std::make_unique<FsstAlgorithm>(std::max(std::thread::hardware_concurrency(), 1U));
+        case AlgorithType::FSSTReuse:
+            return std::make_unique<FsstAlgorithm>(1, true);
+        case AlgorithType::FSST12Reuse:
+            return std::make_unique<Fsst12Algorithm>(true);
+        case AlgorithType::DictionaryFSST:
+            return std::make_unique<DictionaryFsstAlgorithm>();
+        case AlgorithType::Zstd:
+            return std::make_unique<ZstdAlgorithm>(ZstdAlgorithm::DictionaryMode::None, block_codec_parameters);
+        case AlgorithType::ZstdRowGroupDict:
+            return std::make_unique<ZstdAlgorithm>(ZstdAlgorithm::DictionaryMode::RowGroup, block_codec_parameters);
+        case AlgorithType::ZstdColumnDict:
+            return std::make_unique<ZstdAlgorithm>(ZstdAlgorithm::DictionaryMode::Column, block_codec_parameters);
+        case AlgorithType::LZ4Dict:
+            return std::make_unique<LZ4Algorithm>(true, block_codec_parameters);
+        case AlgorithType::FrontCoding:
+            return std::make_unique<FrontCodingAlgorithm>();
+        case AlgorithType::FrontCodingFSST:
+            return std::make_unique<FrontCodingAlgorithm>(true);
+        case AlgorithType::RLEDictionary:
+            return std::make_unique<RleDictionaryAlgorithm>();
+        case AlgorithType::DictionaryHuffman:
+            return std::make_unique<DictionaryHuffmanAlgorithm>();
+        case AlgorithType::FSSTHuffman:
+            return std::make_unique<FsstHuffmanAlgorithm>();
+        case AlgorithType::Cascade:
+            return std::make_unique<CascadeAlgorithm>();
+        case AlgorithType::TypedString:
+            return std::make_unique<TypedStringAlgorithm>();
+        case AlgorithType::Template:
+            return std::make_unique<TemplateAlgorithm>();
+        case AlgorithType::OrderedDictionary:
+            return std::make_unique<DictionaryAlgorithm>(true, std::max(std::thread::hardware_concurrency(), 1U));
+        case AlgorithType::FMIndex:
+            return std::make_unique<FmIndexAlgorithm>();
+        default:
+            throw duckdb::Exception(duckdb::ExceptionType::INTERNAL, "Not know!");
+    }
+}
@@ -93,6 +93,39 @@ fsst_create(
    int zeroTerminated       /* IN: whether input strings are zero-terminated. If so, encoded strings are as well (i.e. symbol[0]=""). */
 );
 
+/* Same as fsst_create(), but counts the symbol candidates of the sample on nthreads threads. Yields the same symbol table. */
+fsst_encoder_t*  
+fsst_create_mt(
+   size_t n,         /* IN: number of strings in batch to sample from. */
+   const size_t lenIn[],   /* IN: byte-lengths of the inputs */
+   const unsigned char *strIn[],  /* IN: string start pointers. */
+   int zeroTerminated,      /* IN: whether input strings are zero-terminated. If so, encoded strings are as well (i.e. symbol[0]=""). */
+   unsigned int nthreads    /* IN: number of threads used during symbol table construction. */
+);
+
+/* Opaque training sample, allows to run the two steps of fsst_create() (sampling and symbol table construction) separately. */
+typedef void* fsst_sample_t;
+
+/* Draw the sample fsst_create() trains on. It may point into the input strings, which must stay alive. */
+fsst_sample_t*
+fsst_create_sample(
+   size_t n,         /* IN: number of strings in batch to sample from. */
+   const size_t lenIn[],   /* IN: byte-lengths of the inputs */
+   const unsigned char *strIn[]  /* IN: string start pointers. */
+);
+
+/* Build the symbol table from a sample, same result as fsst_create_mt() on the strings the sample was drawn from. */
+fsst_encoder_t*
+fsst_create_from_sample(
+   fsst_sample_t *sample,   /* IN: sample obtained from fsst_create_sample(). */
+   int zeroTerminated,      /* IN: whether input strings are zero-terminated. If so, encoded strings are as well (i.e. symbol[0]=""). */
+   unsigned int nthreads    /* IN: number of threads used during symbol table construction. */
+);
+
+/* Deallocate a sample. */
+void
+fsst_destroy_sample(fsst_sample_t*);
+
 /* Create another encoder instance, necessary to do multi-threaded encoding using the same symbol table. */ 
 fsst_encoder_t*    
 fsst_duplicate(
@@ -59,7 +59,7 @@ std::ostream& operator<<(std::ostream& out, const Symbol& s) {
    return out;
 }
 
-SymbolTable *buildSymbolTable(Counters& counters, vector<const u8*> line, const size_t len[], bool zeroTerminated=false) {
+SymbolTable *buildSymbolTable(Counters& counters, vector<const u8*> line, const size_t len[], bool zeroTerminated=false, unsigned nThreads=1) {
    SymbolTable *st = new SymbolTable(), *bestTable = new SymbolTable();
    int bestGain = (int) -FSST_SAMPLEMAXSZ; // worst case (everything exception)
    size_t sampleFrac = 128;
@@ -88,11 +88,11 @@ SymbolTable *buildSymbolTable(Counters& counters, vector<const u8*> line, const
    // a random number between 0 and 128
    auto rnd128 = [&](size_t i) { return 1 + (FSST_HASH((i+1UL)*sampleFrac)&127); };
 
-   // compress sample, and compute (pair-)frequencies
-   auto compressCount = [&](SymbolTable *st, Counters &counters) { // returns gain
+   // compress sample lines [lineBegin,lineEnd), and compute (pair-)frequencies into Counters or PartialCounters
+   auto compressCount = [&](SymbolTable *st, auto &counters, size_t lineBegin, size_t lineEnd) { // returns gain
       int gain = 0;
 
-      for(size_t i=0; i<line.size(); i++) {
+      for(size_t i=lineBegin; i<lineEnd; i++) {
          const u8* cur = line[i], *start = cur;
          const u8* end = cur + len[i];
 
@@ -157,6 +157,49 @@ SymbolTable *buildSymbolTable(Counters& counters, vector<const u8*> line, const
       return gain; 
    };
 
+   // every thread counts a contiguous range of the sample lines into its own exact counters, which are summed afterwards.
+   // the sampling decision (rnd128) depends on the global line number only, so this is equivalent to the serial round
+   nThreads = (unsigned) min<size_t>(max(nThreads, 1U), max<size_t>(line.size() / 64, 1)); // at least 64 lines per thread
+   vector<unique_ptr<PartialCounters>> partials;
+   for(unsigned t=0; nThreads > 1 && t<nThreads; t++)
+      partials.emplace_back(new PartialCounters());
+
+   auto compressCountParallel = [&](SymbolTable *st, Counters &counters) { // returns gain
+      vector<int> gains(nThreads, 0);
+      vector<thread> threads;
+      size_t linesPerThread = (line.size() + nThreads - 1) / nThreads;
+      for(unsigned t=0; t<nThreads; t++) {
+         threads.emplace_back([&, t]() {
+            size_t lineBegin = min(line.size(), t*linesPerThread);
+            size_t lineEnd = min(line.size(), lineBegin+linesPerThread);
+            partials[t]->clear();
+            gains[t] = compressCount(st, *partials[t], lineBegin, lineEnd);
+         });
+      }
+      for(auto& th : threads) 
+         th.join();
+
+      memset(&counters, 0, sizeof(Counters));
+      for(u32 pos1=0; pos1<FSST_CODE_MAX; pos1++) {
+         u64 cnt1 = 0, used2 = 0;
+         for(auto& p : partials) {
+            cnt1 += p->count1[pos1];
+            used2 |= p->used2[pos1];
+         }
+         if (cnt1) counters.count1Load(pos1, cnt1);
+         for(u32 pos2=0; used2 && pos2<FSST_CODE_MAX; pos2++) {
+            u64 cnt2 = 0;
+            for(auto& p : partials) 
+               cnt2 += p->count2[pos1][pos2];
+            if (cnt2) counters.count2Load(pos1, pos2, cnt2);
+         }
+      }
+      int gain = 0;
+      for(int g : gains) 
+         gain += g;
+      return gain;
+   };
+
    auto makeTable = [&](SymbolTable *st, Counters &counters) {
       // hashmap of c (needed because we can generate duplicate candidates)
       unordered_set<QSymbol> cands;
@@ -226,8 +269,13 @@ SymbolTable *buildSymbolTable(Counters& counters, vector<const u8*> line, const
 #else
    for(sampleFrac=8; true; sampleFrac += 30) {
 #endif
-      memset(&counters, 0, sizeof(Counters));
-      long gain = compressCount(st, counters);
+      long gain;
+      if (nThreads > 1) {
+         gain = compressCountParallel(st, counters);
+      } else {
+         memset(&counters, 0, sizeof(Counters));
+         gain = compressCount(st, counters, 0, line.size());
+      }
       if (gain >= bestGain) { // a new best solution!
          counters.backup1(bestCounters);
          *bestTable = *st; bestGain = gain;
@@ -495,16 +543,46 @@ vector<const u8*> makeSample(u8* sampleBuf, const u8* strIn[], const size_t **le
 }
 
 extern "C" fsst_encoder_t* fsst_create(size_t n, const size_t lenIn[], const u8 *strIn[], int zeroTerminated) {
-   u8* sampleBuf = new u8[FSST_SAMPLEMAXSZ];
-   const size_t *sampleLen = lenIn;
-   vector<const u8*> sample = makeSample(sampleBuf, strIn, &sampleLen, n?n:1); // careful handling of input to get a right-size and representative sample
+   return fsst_create_mt(n, lenIn, strIn, zeroTerminated, 1);
+}
+
+extern "C" fsst_encoder_t* fsst_create_mt(size_t n, const size_t lenIn[], const u8 *strIn[], int zeroTerminated, unsigned int nthreads) {
+   fsst_sample_t *sample = fsst_create_sample(n, lenIn, strIn);
+   fsst_encoder_t *encoder = fsst_create_from_sample(sample, zeroTerminated, nthreads);
+   fsst_destroy_sample(sample);
+   return encoder;
+}
+
+// the training sample: lines either point into the input strings or into sampleBuf
+struct Sample {
+   u8* sampleBuf;
+   const size_t *lenIn;     // lengths of the input strings
+   const size_t *sampleLen; // lengths of the sample lines (lenIn if the sample is the input itself)
+   vector<const u8*> lines;
+};
+
+extern "C" fsst_sample_t* fsst_create_sample(size_t n, const size_t lenIn[], const u8 *strIn[]) {
+   Sample *sample = new Sample();
+   sample->sampleBuf = new u8[FSST_SAMPLEMAXSZ];
+   sample->lenIn = sample->sampleLen = lenIn;
+   sample->lines = makeSample(sample->sampleBuf, strIn, &sample->sampleLen, n?n:1); // careful handling of input to get a right-size and representative sample
+   return (fsst_sample_t*) sample;
+}
+
+extern "C" fsst_encoder_t* fsst_create_from_sample(fsst_sample_t *sample, int zeroTerminated, unsigned int nthreads) {
+   Sample *s = (Sample*) sample;
    Encoder *encoder = new Encoder();
-   encoder->symbolTable = shared_ptr<SymbolTable>(buildSymbolTable(encoder->counters, sample, sampleLen, zeroTerminated));
-   if (sampleLen != lenIn) delete[] sampleLen; 
-   delete[] sampleBuf; 
+   encoder->symbolTable = shared_ptr<SymbolTable>(buildSymbolTable(encoder->counters, s->lines, s->sampleLen, zeroTerminated, nthreads));
    return (fsst_encoder_t*) encoder;
 }
 
+extern "C" void fsst_destroy_sample(fsst_sample_t *sample) {
+   Sample *s = (Sample*) sample;
+   if (s->sampleLen != s->lenIn) delete[] s->sampleLen; 
+   delete[] s->sampleBuf; 
+   delete s;
+}
+
 /* create another encoder instance, necessary to do multi-threaded encoding using the same symbol table */
 extern "C" fsst_encoder_t* fsst_duplicate(fsst_encoder_t *encoder) {
    Encoder *e = new Encoder();
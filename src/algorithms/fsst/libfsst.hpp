@@ -25,6 +25,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 #include <sys/types.h>
@@ -355,6 +356,13 @@ struct Counters {
    void restore1(u8 *buf) {
       memcpy(count1, buf, FSST_CODE_MAX*sizeof(u16));
    }
+   // load an exact count into a zeroed counter (same state as cnt calls to count1Inc resp. count2Inc)
+   void count1Load(u32 pos1, u64 cnt) { 
+      count1[pos1] = (u16) cnt;
+   }
+   void count2Load(u32 pos1, u32 pos2, u64 cnt) { 
+      count2[pos1][pos2] = (u16) cnt;
+   }
 };
 #else
 // we keep two counters count1[pos] and count2[pos1][pos2] of resp 16 and 12-bits. Both are split into two columns for performance reasons
@@ -416,9 +424,47 @@ struct Counters {
       memcpy(count1High, buf, FSST_CODE_MAX);
       memcpy(count1Low, buf+FSST_CODE_MAX, FSST_CODE_MAX);
    }
+   // load an exact count into a zeroed counter, leaving it in the very state cnt calls to count1Inc() would produce:
+   // low holds cnt%256 and high was incremented once per 256 (early, so ceil(cnt/256) times), both wrapping like the increments do
+   void count1Load(u32 pos1, u64 cnt) { 
+      count1Low[pos1] = (u8) cnt;
+      count1High[pos1] = (u8) ((cnt+255) >> 8);
+   }
+   void count2Load(u32 pos1, u32 pos2, u64 cnt) { 
+      count2Low[pos1][pos2] = (u8) cnt;
+      // adding (rather than storing) the 4-bits high part reproduces the overflow of an even counter into its odd neighbour
+      count2High[pos1][(pos2)>>1] += (u8) (((cnt+255) >> 8) << (((pos2)&1)<<2));
+   }
 }; 
 #endif
 
+// exact (32-bits, non-wrapping) symbol counts of one thread in a parallel symbol table construction round. Summing the
+// partial counts of all threads and loading them into Counters yields exactly the counters a serial round would produce.
+struct PartialCounters {
+   u32 count1[FSST_CODE_MAX];
+   u32 count2[FSST_CODE_MAX][FSST_CODE_MAX];
+   bool used2[FSST_CODE_MAX]; // rows of count2 that received counts (only those need to be cleared and merged)
+
+   PartialCounters() {
+      memset(count1, 0, sizeof(count1));
+      memset(count2, 0, sizeof(count2));
+      memset(used2, 0, sizeof(used2));
+   }
+   void count1Inc(u32 pos1) { 
+      count1[pos1]++;
+   }
+   void count2Inc(u32 pos1, u32 pos2) {  
+      count2[pos1][pos2]++;
+      used2[pos1] = true;
+   }
+   void clear() {
+      memset(count1, 0, sizeof(count1));
+      for(u32 pos1=0; pos1<FSST_CODE_MAX; pos1++) 
+         if (used2[pos1]) memset(count2[pos1], 0, sizeof(count2[pos1]));
+      memset(used2, 0, sizeof(used2));
+   }
+};
+
 
 #define FSST_BUFSZ (3<<19) // 768KB
 
@@ -75,6 +75,27 @@ fsst12_create(
    int dummy
 );
 
+/* Opaque training sample, allows to run the two steps of fsst12_create() (sampling and dictionary construction) separately. */
+typedef void* fsst12_sample_t;
+
+/* Select the sample fsst12_create() trains on. It points into the input strings, which must stay alive. */
+fsst12_sample_t*
+fsst12_create_sample(
+   unsigned long n,         /* IN: number of strings in batch to sample from. */
+   const unsigned long lenIn[],   /* IN: byte-lengths of the inputs */
+   const unsigned char *strIn[]  /* IN: string start pointers. */
+);
+
+/* Build the dictionary from a sample, same result as fsst12_create() on the strings the sample was drawn from. */
+fsst12_encoder_t*
+fsst12_create_from_sample(
+   fsst12_sample_t *sample  /* IN: sample obtained from fsst12_create_sample(). */
+);
+
+/* Deallocate a sample. */
+void
+fsst12_destroy_sample(fsst12_sample_t*);
+
 /* Create another encoder instance, necessary to do multi-threaded encoding using the same dictionary. */
 fsst12_encoder_t*
 fsst12_duplicate(
@@ -303,14 +303,42 @@ long makeSample(vector<ulong> &sample, ulong nlines, const ulong len[]) {
 
 using namespace libfsst12;
 extern "C" fsst12_encoder_t* fsst12_create(ulong n, const ulong lenIn[], const u8 *strIn[], int dummy) {
-   vector<ulong> sample;
    (void) dummy;
-   long sampleSize = makeSample(sample, n?n:1, lenIn); // careful handling of input to get a right-size and representative sample
+   fsst12_sample_t *sample = fsst12_create_sample(n, lenIn, strIn);
+   fsst12_encoder_t *encoder = fsst12_create_from_sample(sample);
+   fsst12_destroy_sample(sample);
+   return encoder;
+}
+
+namespace libfsst12 {
+// the training sample: the numbers of the sampled input lines
+struct Sample {
+   vector<ulong> lines;
+   long sampleSize;
+   const ulong *lenIn;
+   const u8 **strIn;
+};
+}  // namespace libfsst12
+
+extern "C" fsst12_sample_t* fsst12_create_sample(ulong n, const ulong lenIn[], const u8 *strIn[]) {
+   Sample *sample = new Sample();
+   sample->sampleSize = makeSample(sample->lines, n?n:1, lenIn); // careful handling of input to get a right-size and representative sample
+   sample->lenIn = lenIn;
+   sample->strIn = strIn;
+   return (fsst12_sample_t*) sample;
+}
+
+extern "C" fsst12_encoder_t* fsst12_create_from_sample(fsst12_sample_t *sample) {
+   Sample *s = (Sample*) sample;
    Encoder *encoder = new Encoder();
-   encoder->symbolMap = shared_ptr<SymbolMap>(buildSymbolMap(encoder->counters, sampleSize, sample, lenIn, strIn));
+   encoder->symbolMap = shared_ptr<SymbolMap>(buildSymbolMap(encoder->counters, s->sampleSize, s->lines, s->lenIn, s->strIn));
    return (fsst12_encoder_t*) encoder;
 }
 
+extern "C" void fsst12_destroy_sample(fsst12_sample_t *sample) {
+   delete (Sample*) sample;
+}
+
 /* create another encoder instance, necessary to do multi-threaded encoding using the same dictionary */
 extern "C" fsst12_encoder_t* fsst12_duplicate(fsst12_encoder_t *encoder) {
   Encoder *e = new Encoder();
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/string_utils.hpp"
+
+// Runs another algorithm on the strings without the longest prefix and suffix all strings of the row group share,
+// e.g. the https://www.example.com/ of URLs or the @example.com of emails, and attaches them again on decompression.
+// Affixes of up to AFFIX_COPY_SIZE bytes are copied as one block of that size. It is reported as the inner algorithm
+// with strip_affixes in its parameters, the affixes count as dictionary and the bitpacked lengths of the stripped
+// strings, which place the affixes on full decompression, as data
+class AffixStrippingAlgorithm final : public ICompressionAlgorithm {
+public:
+    static constexpr size_t AFFIX_COPY_SIZE = 16;
+
+    // the inner algorithm is initialized for every run like an algorithm that runs on its own
+    explicit AffixStrippingAlgorithm(std::unique_ptr<ICompressionAlgorithm> inner) : inner_(std::move(inner)) {
+    }
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return inner_->GetAlgorithmType();
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        const auto inner_parameters = inner_->GetParameters();
+        return inner_parameters.empty() ? "strip_affixes" : "strip_affixes;" + inner_parameters;
+    }
+
+    [[nodiscard]] std::string GetChosenScheme() const override {
+        const auto inner_scheme = inner_->GetChosenScheme();
+        const auto affixes = "prefix=" + std::to_string(prefix_length_) + ";suffix=" + std::to_string(suffix_length_);
+        return inner_scheme.empty() ? affixes : affixes + ";" + inner_scheme;
+    }
+
+    [[nodiscard]] BlockCacheCounters GetBlockCacheCounters() const override {
+        return inner_->GetBlockCacheCounters();
+    }
+
+    void ResetDecompressionCaches() override {
+        inner_->ResetDecompressionCaches();
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        // tables the inner algorithm reuses are trained on stripped strings, so they are kept apart from the others
+        ColumnContext *column_context = input.column_context;
+        if (column_context != nullptr) {
+            if (!column_context->affix_stripped) {
+                column_context->affix_stripped = std::make_unique<ColumnContext>();
+            }
+            column_context = column_context->affix_stripped.get();
+        }
+        inner_input_ = std::make_unique<ExperimentInput>(ExperimentInput{
+            input.collector, input.random_row_indices, input.random_vector_indices, input.row_group_idx, column_context,
+            input.auto_select_candidates, input.selection_goals, input.run_queries, input.build_synopses
+        });
+        inner_->Initialize(*inner_input_);
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        // the affixes are copied as blocks of AFFIX_COPY_SIZE bytes, the one after the last string needs the room
+        return inner_->GetDecompressionBufferSize(decompressed_size) + AFFIX_COPY_SIZE;
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_rows_ = data.Size();
+        stripped_.reset();
+        packed_stripped_lengths_.clear();
+        {
+            // preparing the strings the inner algorithm samples from
+            auto timer = TimePhase(CompressionPhase::Sample);
+            FindAffixes(data);
+            if (prefix_length_ + suffix_length_ > 0) {
+                const auto pointers = data.GetPointers();
+                stripped_ = std::make_unique<StringCollector>(
+                    data.TotalBytes() - n_rows_ * (prefix_length_ + suffix_length_), n_rows_);
+                for (size_t i = 0; i < n_rows_; i++) {
+                    const size_t length = pointers[i + 1] - pointers[i];
+                    stripped_->AddString(std::string_view(reinterpret_cast<const char *>(pointers[i]) + prefix_length_,
+                                                          length - prefix_length_ - suffix_length_));
+                }
+            }
+        }
+
+        inner_->CompressAll(stripped_ ? *stripped_ : data);
+        compression_phase_times_ += inner_->GetCompressionPhaseTimes();
+        symbol_table_reuse_ = inner_->GetSymbolTableReuse();
+        if (stripped_) {
+            auto timer = TimePhase(CompressionPhase::Finalize);
+            PackStrippedLengths();
+            stripped_buffer_.resize(inner_->GetDecompressionBufferSize(stripped_->TotalBytes()));
+            if (!inner_->ReferencesInput()) {
+                stripped_.reset();
+            }
+        }
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        if (prefix_length_ + suffix_length_ == 0) {
+            inner_->DecompressAll(out, out_capacity);
+            return;
+        }
+        // the stripped strings are decompressed at once like the inner algorithm does on its own, the affixes are
+        // attached while they are moved to out by the lengths of the stripped strings
+        inner_->DecompressAll(stripped_buffer_.data(), stripped_buffer_.size());
+
+        const uint8_t *read_ptr = stripped_buffer_.data();
+        uint8_t *write_ptr = out;
+        for (size_t i = 0; i < n_rows_; i++) {
+            const size_t length = min_stripped_length_ +
+                                  BitPackingUtils::Unpack(packed_stripped_lengths_.data(), stripped_length_bits_, i);
+            CopyAffix(write_ptr, out_capacity - (write_ptr - out), prefix_.data(), prefix_length_);
+            write_ptr += prefix_length_;
+            std::memcpy(write_ptr, read_ptr, length);
+            read_ptr += length;
+            write_ptr += length;
+            CopyAffix(write_ptr, out_capacity - (write_ptr - out), suffix_.data(), suffix_length_);
+            write_ptr += suffix_length_;
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        CopyAffix(out, out_capacity, prefix_.data(), prefix_length_);
+        const idx_t length = inner_->DecompressOne(index, out + prefix_length_, out_capacity - prefix_length_);
+        const size_t suffix_start = prefix_length_ + length;
+        CopyAffix(out + suffix_start, out_capacity - suffix_start, suffix_.data(), suffix_length_);
+        return suffix_start + suffix_length_;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        // the affixes and their lengths are part of the dictionary, the lengths of the stripped strings of the data
+        auto info = inner_->CompressedSize();
+        const uint64_t affixes_size = prefix_length_ + suffix_length_;
+        const uint64_t affix_lengths_size = 2 * sizeof(uint32_t);
+        info.parts.size_dictionary_strings += affixes_size;
+        info.parts.size_dictionary_lengths += affix_lengths_size;
+        info.parts.size_dictionary += affixes_size + affix_lengths_size;
+        const uint64_t stripped_lengths_size = packed_stripped_lengths_.empty()
+                                                   ? 0
+                                                   : sizeof(min_stripped_length_) + packed_stripped_lengths_.size() -
+                                                     BitPackingUtils::PACKING_PADDING;
+        info.parts.size_data_lengths += stripped_lengths_size;
+        info.parts.size_data += stripped_lengths_size;
+        info.compressed_size += affixes_size + affix_lengths_size + stripped_lengths_size;
+        return info;
+    }
+
+    // Views are not forwarded: the inner algorithm has the stripped strings in memory, the affixes would have to be
+    // copied to them, which is what DecompressAll does
+    bool DecompressAllViews(std::string_view *views) override {
+        return false;
+    }
+
+    bool DecompressOneView(size_t index, std::string_view &view) override {
+        return false;
+    }
+
+    // a value without the affixes matches no row, the others are looked up without them
+    bool FilterEquals(const std::string_view value, std::vector<uint32_t> &rows) override {
+        if (value.size() < prefix_length_ + suffix_length_ || !value.starts_with(Prefix()) ||
+            !value.ends_with(Suffix())) {
+            rows.clear();
+            return true;
+        }
+        return inner_->FilterEquals(value.substr(prefix_length_, value.size() - prefix_length_ - suffix_length_),
+                                    rows);
+    }
+
+    // The order kernels are forwarded only without a suffix: a stripped string that is a prefix of another one sorts
+    // before it, with the suffix attached again it may not
+    bool FilterRange(const std::string_view low, const std::string_view high, std::vector<uint32_t> &rows) override {
+        if (suffix_length_ > 0) return false;
+
+        std::string_view stripped_low;
+        std::string_view stripped_high;
+        const BoundPosition low_position = PlaceBound(low, stripped_low);
+        const BoundPosition high_position = PlaceBound(high, stripped_high);
+        if (low_position == BoundPosition::Above || high_position == BoundPosition::Below) {
+            rows.clear();
+            return true;
+        }
+        if (high_position == BoundPosition::Above) {
+            // no stripped string bounds them from above
+            return false;
+        }
+        // below all strings, the empty string bounds them from below
+        return inner_->FilterRange(low_position == BoundPosition::Below ? std::string_view() : stripped_low,
+                                   stripped_high, rows);
+    }
+
+    bool MinMaxPerVector(std::vector<std::string> &mins, std::vector<std::string> &maxes) override {
+        if (suffix_length_ > 0 || !inner_->MinMaxPerVector(mins, maxes)) return false;
+
+        for (auto &min: mins) {
+            min.insert(0, Prefix());
+        }
+        for (auto &max: maxes) {
+            max.insert(0, Prefix());
+        }
+        return true;
+    }
+
+    bool SortRows(std::vector<uint32_t> &rows) override {
+        return suffix_length_ == 0 && inner_->SortRows(rows);
+    }
+
+    // the groups of the stripped strings, with the affixes attached again
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        if (!inner_->GroupCount(groups)) return false;
+
+        group_strings_.resize(groups.size());
+        for (size_t i = 0; i < groups.size(); i++) {
+            group_strings_[i].assign(Prefix());
+            group_strings_[i].append(groups[i].first);
+            group_strings_[i].append(Suffix());
+        }
+        for (size_t i = 0; i < groups.size(); i++) {
+            groups[i].first = group_strings_[i];
+        }
+        return true;
+    }
+
+    // A needle in an affix is in every row. One that cannot reach into an affix, because no end of it overlaps the
+    // adjacent end of the affix, is in the rows whose stripped string contains it. The others are answered on the
+    // decompressed strings
+    bool FilterContains(const std::string_view needle, std::vector<uint32_t> &rows) override {
+        if (Prefix().find(needle) != std::string_view::npos || Suffix().find(needle) != std::string_view::npos) {
+            rows.resize(n_rows_);
+            std::iota(rows.begin(), rows.end(), 0);
+            return true;
+        }
+        for (size_t overlap = 1; overlap < needle.size(); overlap++) {
+            if ((overlap <= prefix_length_ && Prefix().ends_with(needle.substr(0, overlap))) ||
+                (overlap <= suffix_length_ && Suffix().starts_with(needle.substr(needle.size() - overlap)))) {
+                return false;
+            }
+        }
+        return inner_->FilterContains(needle, rows);
+    }
+
+    // the affixes of all rows are equal, so the keys of the stripped strings are equal iff the strings are
+    bool CompressedKeys(std::vector<std::string_view> &keys) override {
+        return inner_->CompressedKeys(keys);
+    }
+
+    void Free() override {
+        inner_->Free();
+        group_strings_.clear();
+        stripped_.reset();
+        packed_stripped_lengths_.clear();
+        stripped_buffer_.clear();
+        stripped_buffer_.shrink_to_fit();
+        prefix_.clear();
+        suffix_.clear();
+        prefix_length_ = 0;
+        suffix_length_ = 0;
+    }
+
+private:
+    // the longest prefix and suffix of all strings, together at most as long as the shortest string. They are kept
+    // with AFFIX_COPY_SIZE bytes of room
+    void FindAffixes(const StringCollector &data) {
+        prefix_length_ = 0;
+        suffix_length_ = 0;
+        if (n_rows_ == 0) {
+            return;
+        }
+        const auto pointers = data.GetPointers();
+        const uint8_t *first = pointers[0];
+        const size_t first_length = pointers[1] - pointers[0];
+        size_t prefix_length = first_length;
+        size_t suffix_length = first_length;
+        size_t min_length = first_length;
+        for (size_t i = 1; i < n_rows_ && prefix_length + suffix_length > 0; i++) {
+            const size_t length = pointers[i + 1] - pointers[i];
+            prefix_length = CommonPrefixLength(first, prefix_length, pointers[i], length);
+            suffix_length = CommonSuffixLength(first + first_length - suffix_length, suffix_length, pointers[i], length);
+            min_length = std::min(min_length, length);
+        }
+        prefix_length_ = std::min(prefix_length, min_length);
+        suffix_length_ = std::min(suffix_length, min_length - prefix_length_);
+
+        prefix_.assign(first, first + prefix_length_);
+        suffix_.assign(first + first_length - suffix_length_, first + first_length);
+        prefix_.resize(prefix_length_ + AFFIX_COPY_SIZE, 0);
+        suffix_.resize(suffix_length_ + AFFIX_COPY_SIZE, 0);
+    }
+
+    [[nodiscard]] std::string_view Prefix() const {
+        return {reinterpret_cast<const char *>(prefix_.data()), prefix_length_};
+    }
+
+    [[nodiscard]] std::string_view Suffix() const {
+        return {reinterpret_cast<const char *>(suffix_.data()), suffix_length_};
+    }
+
+    enum class BoundPosition { Below, Among, Above };
+
+    // where a range bound lies relative to the strings, which all start with the prefix: below or above all of them,
+    // or among them with the part after the prefix in stripped
+    [[nodiscard]] BoundPosition PlaceBound(const std::string_view bound, std::string_view &stripped) const {
+        const size_t common = CommonPrefixLength(reinterpret_cast<const uint8_t *>(bound.data()), bound.size(),
+                                                 prefix_.data(), prefix_length_);
+        if (common == prefix_length_) {
+            stripped = bound.substr(prefix_length_);
+            return BoundPosition::Among;
+        }
+        // a proper prefix of the prefix is below all strings
+        if (common == bound.size()) return BoundPosition::Below;
+        return static_cast<uint8_t>(bound[common]) < prefix_[common] ? BoundPosition::Below : BoundPosition::Above;
+    }
+
+    // the stripped lengths relative to the shortest one, DecompressAll needs them to place the affixes
+    void PackStrippedLengths() {
+        std::vector<uint32_t> lengths(n_rows_);
+        for (size_t i = 0; i < n_rows_; i++) {
+            lengths[i] = stripped_->GetLength(i);
+        }
+        const auto [min_it, max_it] = std::minmax_element(lengths.begin(), lengths.end());
+        min_stripped_length_ = *min_it;
+        stripped_length_bits_ = BitPackingUtils::GetBitsPerValue(*max_it - min_stripped_length_);
+        for (auto &length: lengths) {
+            length -= min_stripped_length_;
+        }
+        packed_stripped_lengths_ = BitPackingUtils::Pack(lengths, stripped_length_bits_);
+    }
+
+    static inline void CopyAffix(uint8_t *out, const size_t out_capacity, const uint8_t *affix, const size_t length) {
+        if (length <= AFFIX_COPY_SIZE && out_capacity >= AFFIX_COPY_SIZE) {
+            std::memcpy(out, affix, AFFIX_COPY_SIZE);
+        } else {
+            std::memcpy(out, affix, length);
+        }
+    }
+
+    std::unique_ptr<ICompressionAlgorithm> inner_;
+    std::unique_ptr<ExperimentInput> inner_input_;
+    // the strings without the affixes, kept after CompressAll only for inner algorithms that point into them
+    std::unique_ptr<StringCollector> stripped_;
+    uint32_t min_stripped_length_{0};
+    uint8_t stripped_length_bits_{1};
+    std::vector<uint8_t> packed_stripped_lengths_;
+    // the inner algorithm decompresses the stripped strings into it
+    std::vector<uint8_t> stripped_buffer_;
+    bool compressed_ready_{false};
+    size_t n_rows_{0};
+
+    // the strings of the last GroupCount, with the affixes
+    std::vector<std::string> group_strings_;
+
+    std::vector<uint8_t> prefix_;
+    std::vector<uint8_t> suffix_;
+    size_t prefix_length_{0};
+    size_t suffix_length_{0};
+};
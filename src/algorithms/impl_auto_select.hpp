@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "interface.hpp"
+#include "factory.hpp"
+
+// What the cost model of AutoSelect knows about a candidate, estimated on a sample or measured on the full row group
+struct CandidateEstimate {
+    AlgorithType algorithm;
+    double compression_ratio;
+    double decompression_ns_per_byte;
+    double lookup_latency_ns;
+};
+
+// The cost of every candidate: per goal how many times worse than the best candidate it is, averaged by the weights of
+// the goals. The best candidate for every goal costs 1
+inline std::vector<double> SelectionCosts(const std::vector<CandidateEstimate> &candidates, const SelectionGoals &goals) {
+    std::vector<double> costs(candidates.size(), 0.0);
+    if (candidates.empty()) {
+        return costs;
+    }
+
+    double best_ratio = 0.0;
+    double best_decompression = std::numeric_limits<double>::max();
+    double best_latency = std::numeric_limits<double>::max();
+    for (const auto &candidate: candidates) {
+        best_ratio = std::max(best_ratio, candidate.compression_ratio);
+        best_decompression = std::min(best_decompression, candidate.decompression_ns_per_byte);
+        best_latency = std::min(best_latency, candidate.lookup_latency_ns);
+    }
+
+    // a goal nobody can be compared on (e.g. all measured as 0 ns) does not count
+    const auto relative = [](const double value, const double best) {
+        return value <= 0.0 || best <= 0.0 ? 1.0 : value / best;
+    };
+    const double total_weight = goals.compression_ratio + goals.decompression_speed + goals.random_access;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const auto &candidate = candidates[i];
+        const double cost = goals.compression_ratio * relative(best_ratio, candidate.compression_ratio) +
+                            goals.decompression_speed * relative(candidate.decompression_ns_per_byte, best_decompression) +
+                            goals.random_access * relative(candidate.lookup_latency_ns, best_latency);
+        costs[i] = total_weight > 0.0 ? cost / total_weight : 1.0;
+    }
+    return costs;
+}
+
+// Compresses a sample of AUTO_SELECT_SAMPLE_RUNS runs of consecutive strings with every candidate, predicts the
+// compression ratio, decompression speed and lookup latency of the full row group from it and compresses the row group
+// with the candidate the cost model of the selection goals rates best. Choosing counts as the sample phase
+class AutoSelectAlgorithm final : public ICompressionAlgorithm {
+public:
+    explicit AutoSelectAlgorithm(const BlockCodecParameters &block_codec_parameters = {})
+        : block_codec_parameters_(block_codec_parameters) {
+    }
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::AutoSelect;
+    }
+
+    [[nodiscard]] std::string GetChosenScheme() const override {
+        return chosen_ ? ToString(chosen_->GetAlgorithmType()) : "";
+    }
+
+    [[nodiscard]] BlockCacheCounters GetBlockCacheCounters() const override {
+        return chosen_ ? chosen_->GetBlockCacheCounters() : BlockCacheCounters{};
+    }
+
+    [[nodiscard]] bool ReferencesInput() const override {
+        return chosen_ && chosen_->ReferencesInput();
+    }
+
+    void ResetDecompressionCaches() override {
+        if (chosen_) {
+            chosen_->ResetDecompressionCaches();
+        }
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        input_ = &input;
+        candidates_.clear();
+        for (const AlgorithType candidate: input.auto_select_candidates) {
+            if (candidate != AlgorithType::AutoSelect &&
+                std::find(candidates_.begin(), candidates_.end(), candidate) == candidates_.end()) {
+                candidates_.push_back(candidate);
+            }
+        }
+        if (candidates_.empty()) {
+            ErrorHandler::HandleInvalidArgumentError("AutoSelect needs at least one other algorithm to choose from");
+        }
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return chosen_->GetDecompressionBufferSize(decompressed_size);
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        AlgorithType choice;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            choice = Choose(data);
+        }
+
+        chosen_ = CreateAlgorithm(choice, block_codec_parameters_);
+        chosen_->Initialize(*input_);
+        auto timer = TimePhase(CompressionPhase::Encode);
+        chosen_->CompressAll(data);
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!chosen_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        chosen_->DecompressAll(out, out_capacity);
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!chosen_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        return chosen_->DecompressOne(index, out, out_capacity);
+    }
+
+    bool DecompressAllViews(std::string_view *views) override {
+        return chosen_ && chosen_->DecompressAllViews(views);
+    }
+
+    bool DecompressOneView(size_t index, std::string_view &view) override {
+        return chosen_ && chosen_->DecompressOneView(index, view);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!chosen_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        return chosen_->CompressedSize();
+    }
+
+    bool FilterEquals(const std::string_view value, std::vector<uint32_t> &rows) override {
+        return chosen_ && chosen_->FilterEquals(value, rows);
+    }
+
+    bool FilterRange(const std::string_view low, const std::string_view high, std::vector<uint32_t> &rows) override {
+        return chosen_ && chosen_->FilterRange(low, high, rows);
+    }
+
+    bool MinMaxPerVector(std::vector<std::string> &mins, std::vector<std::string> &maxes) override {
+        return chosen_ && chosen_->MinMaxPerVector(mins, maxes);
+    }
+
+    bool SortRows(std::vector<uint32_t> &rows) override {
+        return chosen_ && chosen_->SortRows(rows);
+    }
+
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        return chosen_ && chosen_->GroupCount(groups);
+    }
+
+    bool FilterContains(const std::string_view needle, std::vector<uint32_t> &rows) override {
+        return chosen_ && chosen_->FilterContains(needle, rows);
+    }
+
+    bool CompressedKeys(std::vector<std::string_view> &keys) override {
+        return chosen_ && chosen_->CompressedKeys(keys);
+    }
+
+    void Free() override {
+        if (chosen_) {
+            chosen_->Free();
+        }
+        chosen_.reset();
+    }
+
+private:
+    AlgorithType Choose(const StringCollector &data) const {
+        // runs of consecutive strings keep the local repetition dictionaries and RLE live on
+        StringCollector sample(0, AUTO_SELECT_SAMPLE_RUNS * AUTO_SELECT_SAMPLE_RUN_LENGTH);
+        const size_t run_length = std::min(AUTO_SELECT_SAMPLE_RUN_LENGTH, data.Size());
+        const size_t stride = std::max<size_t>(data.Size() / AUTO_SELECT_SAMPLE_RUNS, run_length);
+        for (size_t start = 0; start + run_length <= data.Size() && sample.Size() < AUTO_SELECT_SAMPLE_RUNS * run_length;
+             start += stride) {
+            for (size_t i = start; i < start + run_length; i++) {
+                sample.AddString(data.Get(i));
+            }
+        }
+        if (sample.Size() == 0 || candidates_.size() == 1) {
+            return candidates_.front();
+        }
+
+        std::vector<CandidateEstimate> estimates;
+        for (const AlgorithType candidate: candidates_) {
+            estimates.push_back(Estimate(candidate, sample, data));
+        }
+        const auto costs = SelectionCosts(estimates, input_->selection_goals);
+        return candidates_[std::min_element(costs.begin(), costs.end()) - costs.begin()];
+    }
+
+    // the compression ratio of the row group predicted from the sample: the size of the tables the candidate trains
+    // stays, the rest grows with the number of rows
+    CandidateEstimate Estimate(const AlgorithType candidate, StringCollector &sample, const StringCollector &data) const {
+        using clock = std::chrono::high_resolution_clock;
+        // the sample belongs to no column, so it neither uses nor stores trained symbol tables
+        const ExperimentInput sample_input{sample, {}, {}, input_->row_group_idx, nullptr};
+        const auto algorithm = CreateAlgorithm(candidate, block_codec_parameters_);
+        algorithm->Initialize(sample_input);
+        algorithm->CompressAll(sample);
+        const auto size_info = algorithm->CompressedSize();
+        const double scale = static_cast<double>(data.Size()) / static_cast<double>(sample.Size());
+        const double predicted_size = static_cast<double>(size_info.compressed_size - size_info.size_fixed) * scale +
+                                      static_cast<double>(size_info.size_fixed);
+
+        const idx_t buffer_size = algorithm->GetDecompressionBufferSize(sample.TotalBytes());
+        std::vector<uint8_t> buffer(buffer_size);
+        const size_t lookup_stride = std::max<size_t>(sample.Size() / AUTO_SELECT_SAMPLE_LOOKUPS, 1);
+        size_t n_lookups = 0;
+        for (size_t i = 0; i < sample.Size(); i += lookup_stride) {
+            n_lookups++;
+        }
+        // the fastest of the timed runs, the warm-up run is not timed
+        const auto best_ns = [&](const auto &run) {
+            run();
+            double best = std::numeric_limits<double>::max();
+            for (size_t run_idx = 0; run_idx < AUTO_SELECT_TIMED_RUNS; run_idx++) {
+                const auto start = clock::now();
+                run();
+                best = std::min(best, std::chrono::duration<double, std::nano>(clock::now() - start).count());
+            }
+            return best;
+        };
+        const double decompression_ns = best_ns([&] { algorithm->DecompressAll(buffer.data(), buffer_size); });
+        const double lookup_ns = best_ns([&] {
+            for (size_t i = 0; i < sample.Size(); i += lookup_stride) {
+                algorithm->DecompressOne(i, buffer.data(), buffer_size);
+            }
+        });
+        algorithm->Free();
+
+        return {
+            candidate,
+            predicted_size == 0.0 ? 0.0 : static_cast<double>(data.TotalSizeRequired()) / predicted_size,
+            decompression_ns / static_cast<double>(std::max<size_t>(sample.TotalBytes(), 1)),
+            lookup_ns / static_cast<double>(n_lookups)
+        };
+    }
+
+    BlockCodecParameters block_codec_parameters_;
+    const ExperimentInput *input_{nullptr};
+    std::vector<AlgorithType> candidates_;
+    std::unique_ptr<ICompressionAlgorithm> chosen_;
+};
+
+// Rates the candidates AutoSelect chose among by their results on the full row group and stores the best one and the
+// regret of the prediction in every AutoSelect result. Block codecs are rated by their first configuration, the one
+// AutoSelect compresses with. AutoSelect on strings without their affixes is rated against the candidates that ran
+// without them, the others against the ones that did not
+inline void EvaluateAutoSelect(std::vector<AlgorithmResult> &results, const idx_t uncompressed_size,
+                               const SelectionGoals &goals) {
+    const auto strips_affixes = [](const AlgorithmResult &result) {
+        return result.parameters.rfind("strip_affixes", 0) == 0;
+    };
+
+    for (const bool stripped: {false, true}) {
+        std::vector<CandidateEstimate> measured;
+        for (const auto &result: results) {
+            const bool seen = std::any_of(measured.begin(), measured.end(), [&](const CandidateEstimate &candidate) {
+                return candidate.algorithm == result.algorithm;
+            });
+            if (result.algorithm == AlgorithType::AutoSelect || strips_affixes(result) != stripped || seen ||
+                result.has_error) {
+                continue;
+            }
+            const auto compressed_size = static_cast<double>(result.compressed_size_info.compressed_size);
+            measured.push_back({
+                result.algorithm,
+                compressed_size == 0.0 ? 0.0 : static_cast<double>(uncompressed_size) / compressed_size,
+                result.decompression_time_ms_full * 1e6 / static_cast<double>(std::max<idx_t>(uncompressed_size, 1)),
+                result.access_random.lookup_latency_ns
+            });
+        }
+        if (measured.empty()) {
+            continue;
+        }
+
+        const auto costs = SelectionCosts(measured, goals);
+        const size_t best_idx = std::min_element(costs.begin(), costs.end()) - costs.begin();
+        for (auto &result: results) {
+            if (result.algorithm != AlgorithType::AutoSelect || strips_affixes(result) != stripped) {
+                continue;
+            }
+            // the scheme comes last, after the affixes of a stripped result
+            const auto chosen = result.chosen_scheme.substr(result.chosen_scheme.rfind(';') + 1);
+            for (size_t i = 0; i < measured.size(); i++) {
+                if (ToString(measured[i].algorithm) == chosen) {
+                    result.auto_select = {ToString(measured[best_idx].algorithm), costs[i] - costs[best_idx]};
+                }
+            }
+        }
+    }
+}
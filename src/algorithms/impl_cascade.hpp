@@ -0,0 +1,98 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "interface.hpp"
+#include "cascade.hpp"
+
+// BtrBlocks-style cascading compression: the column is split by the string scheme (raw, dictionary, RLE or FSST) that
+// compresses a sample best, the resulting strings and integer streams are compressed the same way by the next level,
+// integer streams with bitpacking, FOR or RLE. The cascade chosen for the row group is reported as its scheme
+class CascadeAlgorithm final : public ICompressionAlgorithm {
+public:
+    CascadeAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::Cascade;
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        return "max_depth=" + std::to_string(CASCADE_MAX_DEPTH);
+    }
+
+    [[nodiscard]] std::string GetChosenScheme() const override {
+        return root ? root->Describe() : "";
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        const auto pointers = data.GetPointers();
+        const auto lengths = data.GetLengths();
+        std::vector<std::string_view> strings(data.Size());
+        for (size_t i = 0; i < data.Size(); i++) {
+            strings[i] = std::string_view(reinterpret_cast<const char *>(pointers[i]), lengths[i]);
+        }
+
+        // choosing a scheme happens at every level while the levels above are compressed, so the time spent on it is
+        // summed up by the compressor and the rest counted as encoding
+        CascadeCompressor compressor;
+        const auto start = std::chrono::high_resolution_clock::now();
+        root = compressor.CompressStrings(strings, CASCADE_MAX_DEPTH);
+        const auto end = std::chrono::high_resolution_clock::now();
+        const double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        compression_phase_times_.sample_ms += compressor.selection_ms;
+        compression_phase_times_.encode_ms += total_ms - compressor.selection_ms;
+
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        root->DecodeAll(out, out_capacity, nullptr);
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        return root->Get(index, out, out_capacity);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        const size_t symbol_tables_size = root->SymbolTablesSize();
+        switch (root->scheme) {
+            case StringScheme::Dictionary:
+                return CompressedSizeInfo::Cascade(symbol_tables_size, root->values->SizeInBytes(),
+                                                   root->codes->SizeInBytes(), 0);
+            case StringScheme::RLE:
+                // like RLEDictionary, the strings of the runs are the codes and the rows they end at the lengths
+                return CompressedSizeInfo::Cascade(symbol_tables_size, symbol_tables_size,
+                                                   root->values->SizeInBytes() - symbol_tables_size,
+                                                   root->codes->SizeInBytes());
+            default:
+                return CompressedSizeInfo::Cascade(symbol_tables_size, symbol_tables_size,
+                                                   root->SizeInBytes() - symbol_tables_size - root->lengths->SizeInBytes(),
+                                                   root->lengths->SizeInBytes());
+        }
+    }
+
+    void Free() override {
+        root.reset();
+    }
+
+private:
+    bool compressed_ready_{false};
+
+    std::unique_ptr<CascadeStrings> root;
+};
@@ -5,18 +5,34 @@
 #include <cstring>
 #include <cmath>
 #include "interface.hpp"
+#include "../utils/bitweaving_utils.hpp"
+#include "../utils/string_utils.hpp"
 #include "../../external/robin_hood/robin_hood.h"
 
+// With order_preserving the unique strings are sorted (on sort_threads threads) before the codes are final, so codes
+// compare like their strings and range predicates, min/max and sorting run on the codes (OrderedDictionary). Filters
+// scan a BitWeaving copy of the codes
 class DictionaryAlgorithm final : public ICompressionAlgorithm {
 public:
-    DictionaryAlgorithm() = default;
+    explicit DictionaryAlgorithm(const bool order_preserving = false, const idx_t sort_threads = 1)
+        : order_preserving_(order_preserving), sort_threads_(std::max<idx_t>(sort_threads, 1)) {
+    }
 
     [[nodiscard]] AlgorithType GetAlgorithmType() const override {
-        return AlgorithType::Dictionary;
+        return order_preserving_ ? AlgorithType::OrderedDictionary : AlgorithType::Dictionary;
     }
 
-    void Initialize(const ExperimentInput &input) override {
+    [[nodiscard]] std::string GetParameters() const override {
+        return order_preserving_ ? "sort_threads=" + std::to_string(sort_threads_) : "";
+    }
 
+    // the dictionary entries are the strings of the row group
+    [[nodiscard]] bool ReferencesInput() const override {
+        return true;
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        run_queries_ = input.run_queries;
     }
 
     idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
@@ -36,35 +52,47 @@ public:
         dictionary_order.reserve(data.Size() / 10 + 1);
         compressed_indices.resize(data.Size());
 
-        // Build dictionary and create index array
-        for (size_t i = 0; i < data.Size(); i++) {
+        // Build dictionary and create index array, the codes are assigned while the hash table is built
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            for (size_t i = 0; i < data.Size(); i++) {
 
-            const uint8_t* ptr = pointers[i];
-            const size_t len = lengths[i];
+                const uint8_t* ptr = pointers[i];
+                const size_t len = lengths[i];
 
-            // Create a string view for lookup
-            std::string_view str_view(reinterpret_cast<const char*>(ptr), len);
+                // Create a string view for lookup
+                std::string_view str_view(reinterpret_cast<const char*>(ptr), len);
 
-            // Check if string is already in dictionary
-            auto it = dictionary.find(str_view);
-            if (it == dictionary.end()) {
-                // New unique string - add to dictionary
-                auto dict_idx = static_cast<uint32_t>(dictionary_order.size());
+                // Check if string is already in dictionary
+                auto it = dictionary.find(str_view);
+                if (it == dictionary.end()) {
+                    // New unique string - add to dictionary
+                    auto dict_idx = static_cast<uint32_t>(dictionary_order.size());
 
-                // Store in dictionary with index
-                dictionary[str_view] = dict_idx;
+                    // Store in dictionary with index
+                    dictionary[str_view] = dict_idx;
 
-                // Store actual string data in dictionary_order
-                dictionary_order.emplace_back(ptr, len);
+                    // Store actual string data in dictionary_order
+                    dictionary_order.emplace_back(ptr, len);
 
-                // Store index for this row
-                compressed_indices[i] = dict_idx;
-            } else {
-                // String already exists - store its index
-                compressed_indices[i] = it->second;
+                    // Store index for this row
+                    compressed_indices[i] = dict_idx;
+                } else {
+                    // String already exists - store its index
+                    compressed_indices[i] = it->second;
+                }
+            }
+            // sorting is part of building the dictionary
+            if (order_preserving_) {
+                SortDictionary();
             }
         }
 
+        if (run_queries_) {
+            // only the filters of the query phases scan them
+            auto timer = TimePhase(CompressionPhase::Finalize);
+            woven_codes.Pack(compressed_indices, dictionary_order.size());
+        }
         compressed_ready_ = true;
     }
 
@@ -92,6 +120,23 @@ public:
         return str_len;
     }
 
+    // the strings stay in the dictionary, every row points at the string of its code
+    bool DecompressAllViews(std::string_view *views) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAllViews called before CompressAll/Benchmark");
+
+        for (size_t i = 0; i < compressed_indices.size(); i++) {
+            views[i] = DictionaryString(compressed_indices[i]);
+        }
+        return true;
+    }
+
+    bool DecompressOneView(size_t index, std::string_view &view) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOneView called before CompressAll/Benchmark");
+
+        view = DictionaryString(compressed_indices[index]);
+        return true;
+    }
+
     CompressedSizeInfo CompressedSize() override {
         if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
 
@@ -111,21 +156,173 @@ public:
         return CompressedSizeInfo::Dictionary(dictionary_strings_size, dictionary_lengths_size, data_codes_size);
     }
 
+    bool FilterEquals(const std::string_view value, std::vector<uint32_t> &rows) override {
+        if (!run_queries_) return false;
+
+        // the hash table has the codes of before sorting
+        uint32_t code;
+        if (order_preserving_) {
+            code = LowerBound(value);
+            if (code == dictionary_order.size() || DictionaryString(code) != value) {
+                rows.clear();
+                return true;
+            }
+        } else {
+            const auto it = dictionary.find(value);
+            if (it == dictionary.end()) {
+                rows.clear();
+                return true;
+            }
+            code = it->second;
+        }
+        woven_codes.FilterRange(code, code, filter_bitmap);
+        WovenCodes::BitmapToRows(filter_bitmap, rows);
+        return true;
+    }
+
+    // the codes of the strings in [low, high] are a contiguous range
+    bool FilterRange(const std::string_view low, const std::string_view high, std::vector<uint32_t> &rows) override {
+        if (!order_preserving_ || !run_queries_) return false;
+
+        const uint32_t first = LowerBound(low);
+        const uint32_t end = UpperBound(high);
+        if (end <= first) {
+            rows.clear();
+            return true;
+        }
+        woven_codes.FilterRange(first, end - 1, filter_bitmap);
+        WovenCodes::BitmapToRows(filter_bitmap, rows);
+        return true;
+    }
+
+    bool MinMaxPerVector(std::vector<std::string> &mins, std::vector<std::string> &maxes) override {
+        if (!order_preserving_) return false;
+
+        mins.clear();
+        maxes.clear();
+        for (size_t start = 0; start < compressed_indices.size(); start += VECTOR_SIZE) {
+            const size_t end = std::min(start + VECTOR_SIZE, compressed_indices.size());
+            uint32_t min = compressed_indices[start];
+            uint32_t max = compressed_indices[start];
+            for (size_t i = start; i < end; i++) {
+                min = std::min(min, compressed_indices[i]);
+                max = std::max(max, compressed_indices[i]);
+            }
+            mins.emplace_back(DictionaryString(min));
+            maxes.emplace_back(DictionaryString(max));
+        }
+        return true;
+    }
+
+    // counting sort by code, which keeps equal strings in row order
+    bool SortRows(std::vector<uint32_t> &rows) override {
+        if (!order_preserving_) return false;
+
+        std::vector<uint32_t> code_starts(dictionary_order.size() + 1, 0);
+        for (const uint32_t code: compressed_indices) {
+            code_starts[code + 1]++;
+        }
+        for (size_t code = 1; code < code_starts.size(); code++) {
+            code_starts[code] += code_starts[code - 1];
+        }
+        rows.resize(compressed_indices.size());
+        for (size_t i = 0; i < compressed_indices.size(); i++) {
+            rows[code_starts[compressed_indices[i]]++] = static_cast<uint32_t>(i);
+        }
+        return true;
+    }
+
+    // a histogram of the codes, no string is hashed
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        std::vector<uint64_t> counts;
+        CodeQueries::Histogram(compressed_indices.data(), compressed_indices.size(), dictionary_order.size(), counts);
+        groups.resize(counts.size());
+        for (size_t code = 0; code < counts.size(); code++) {
+            groups[code] = {DictionaryString(code), counts[code]};
+        }
+        return true;
+    }
+
     void Free() override {
         dictionary.clear();
         dictionary_order.clear();
         compressed_indices.clear();
+        woven_codes.Clear();
     }
 
 private:
+    // Sorts dictionary_order and renumbers the codes of the rows by it. The hash table keeps the codes of before, it is
+    // not used after compressing
+    void SortDictionary() {
+        // the 8 bytes after the prefix all strings share decide most comparisons without touching the strings
+        struct SortEntry {
+            uint64_t key;
+            std::string_view str;
+            uint32_t code;
+        };
+        size_t common_prefix = dictionary_order.empty() ? 0 : dictionary_order[0].second;
+        for (const auto &[str_ptr, str_len]: dictionary_order) {
+            common_prefix = CommonPrefixLength(dictionary_order[0].first, common_prefix, str_ptr, str_len);
+        }
+        std::vector<SortEntry> sorted(dictionary_order.size());
+        for (size_t code = 0; code < dictionary_order.size(); code++) {
+            const auto str = DictionaryString(code);
+            uint64_t key = 0;
+            for (size_t i = common_prefix; i < std::min(common_prefix + 8, str.size()); i++) {
+                key |= static_cast<uint64_t>(static_cast<uint8_t>(str[i])) << (56 - 8 * (i - common_prefix));
+            }
+            sorted[code] = {key, str, static_cast<uint32_t>(code)};
+        }
+        ParallelSort(sorted, [](const SortEntry &a, const SortEntry &b) {
+            return a.key != b.key ? a.key < b.key : a.str < b.str;
+        }, sort_threads_, ORDERED_DICTIONARY_MIN_SORT_CHUNK);
+
+        std::vector<uint32_t> new_codes(sorted.size());
+        for (size_t code = 0; code < sorted.size(); code++) {
+            const auto str = sorted[code].str;
+            dictionary_order[code] = {reinterpret_cast<const uint8_t *>(str.data()), str.size()};
+            new_codes[sorted[code].code] = static_cast<uint32_t>(code);
+        }
+        for (auto &code: compressed_indices) {
+            code = new_codes[code];
+        }
+    }
+
+    [[nodiscard]] std::string_view DictionaryString(const size_t code) const {
+        const auto &[str_ptr, str_len] = dictionary_order[code];
+        return {reinterpret_cast<const char *>(str_ptr), str_len};
+    }
+
+    // the first code whose string is not below str, and the first one whose string is above it
+    [[nodiscard]] uint32_t LowerBound(const std::string_view str) const {
+        return static_cast<uint32_t>(std::partition_point(dictionary_order.begin(), dictionary_order.end(),
+            [&](const auto &entry) {
+                return std::string_view(reinterpret_cast<const char *>(entry.first), entry.second) < str;
+            }) - dictionary_order.begin());
+    }
+
+    [[nodiscard]] uint32_t UpperBound(const std::string_view str) const {
+        return static_cast<uint32_t>(std::partition_point(dictionary_order.begin(), dictionary_order.end(),
+            [&](const auto &entry) {
+                return std::string_view(reinterpret_cast<const char *>(entry.first), entry.second) <= str;
+            }) - dictionary_order.begin());
+    }
+
+    bool order_preserving_;
+    idx_t sort_threads_;
+    bool run_queries_{false};
     bool compressed_ready_{false};
 
     // Map from string to dictionary index
     robin_hood::unordered_map<std::string_view, uint32_t> dictionary;
 
-    // Dictionary in insertion order: stores (pointer, length) pairs
+    // Dictionary in insertion order (sorted with order_preserving): stores (pointer, length) pairs
     std::vector<std::pair<const uint8_t*, size_t>> dictionary_order;
 
     // Compressed data: indices into the dictionary
     std::vector<uint32_t> compressed_indices;
+
+    // the codes again for filter scans, only with the query phases, and the bitmap of the last filter
+    WovenCodes woven_codes;
+    std::vector<uint64_t> filter_bitmap;
 };
\ No newline at end of file
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "fsst/fsst.h"
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/bitweaving_utils.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Dictionary encoding whose unique strings are compressed with FSST. The codes are bitpacked, decoded dictionary
+// entries are cached so repeated lookups of the same code decompress it only once. With the query phases, filters look
+// values up by their compressed bytes and scan a BitWeaving copy of the codes
+class DictionaryFsstAlgorithm final : public ICompressionAlgorithm {
+public:
+    DictionaryFsstAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::DictionaryFSST;
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        compression_buffer_size = input.collector.TotalBytes() * 2 + 1000;
+        compression_buffer = static_cast<uint8_t *>(malloc(compression_buffer_size));
+        run_queries_ = input.run_queries;
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        dictionary_lengths.clear();
+        dictionary_pointers.clear();
+
+        const auto pointers = data.GetPointers();
+        const auto lengths = data.GetLengths();
+
+        std::vector<uint32_t> codes(data.Size());
+        std::vector<size_t> unique_lengths;
+        std::vector<const unsigned char *> unique_pointers;
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            // map from string to dictionary index, only needed while compressing
+            robin_hood::unordered_map<std::string_view, uint32_t> dictionary;
+            dictionary.reserve(data.Size() / 10 + 1); // assume 10% unique strings
+            unique_lengths.reserve(data.Size() / 10 + 1);
+            unique_pointers.reserve(data.Size() / 10 + 1);
+
+            for (size_t i = 0; i < data.Size(); i++) {
+                const std::string_view str_view(reinterpret_cast<const char *>(pointers[i]), lengths[i]);
+                auto [it, inserted] = dictionary.try_emplace(str_view, static_cast<uint32_t>(unique_pointers.size()));
+                if (inserted) {
+                    unique_pointers.push_back(pointers[i]);
+                    unique_lengths.push_back(lengths[i]);
+                }
+                codes[i] = it->second;
+            }
+        }
+
+        const size_t n_unique = unique_pointers.size();
+        fsst_sample_t *sample;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            sample = fsst_create_sample(n_unique, unique_lengths.data(), unique_pointers.data());
+        }
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            encoder = fsst_create_from_sample(sample, false, 1);
+            fsst_destroy_sample(sample);
+        }
+
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            dictionary_lengths.resize(n_unique);
+            dictionary_pointers.resize(n_unique);
+            fsst_compress(
+                encoder,
+                n_unique,
+                unique_lengths.data(),
+                unique_pointers.data(),
+                compression_buffer_size,
+                compression_buffer,
+                dictionary_lengths.data(),
+                dictionary_pointers.data()
+            );
+
+            bits_per_code = BitPackingUtils::GetBitsPerValue(n_unique == 0 ? 0 : n_unique - 1);
+            packed_codes = BitPackingUtils::Pack(codes, bits_per_code);
+        }
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        decoder = fsst_decoder(encoder);
+        compressed_codes.clear();
+        if (run_queries_) {
+            // only the filters of the query phases use them
+            woven_codes.Pack(codes, n_unique);
+            compressed_codes.reserve(n_unique);
+            for (size_t code = 0; code < n_unique; code++) {
+                compressed_codes.emplace(CompressedEntry(code), static_cast<uint32_t>(code));
+            }
+        }
+
+        // all entries fit in the cache once decoded, the cache starts out empty on every run
+        size_t decoded_dictionary_size = 0;
+        for (const size_t length: unique_lengths) {
+            decoded_dictionary_size += length;
+        }
+        decoded_dictionary.resize(decoded_dictionary_size + 32);
+        decoded_entries.resize(n_unique);
+        ResetDecompressionCaches();
+
+        n_rows = data.Size();
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        uint8_t *write_ptr = out;
+        for (size_t i = 0; i < n_rows; i++) {
+            const auto code = static_cast<uint32_t>(BitPackingUtils::Unpack(packed_codes.data(), bits_per_code, i));
+            const DecodedEntry &entry = Lookup(code);
+            std::memcpy(write_ptr, decoded_dictionary.data() + entry.offset, entry.length);
+            write_ptr += entry.length;
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        const auto code = static_cast<uint32_t>(BitPackingUtils::Unpack(packed_codes.data(), bits_per_code, index));
+        const DecodedEntry &entry = Lookup(code);
+        std::memcpy(out, decoded_dictionary.data() + entry.offset, entry.length);
+        return entry.length;
+    }
+
+    // views of the decoded dictionary, which is allocated up front and not moved by decoding more of its strings
+    bool DecompressAllViews(std::string_view *views) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAllViews called before CompressAll/Benchmark");
+
+        const auto *decoded = reinterpret_cast<const char *>(decoded_dictionary.data());
+        for (size_t i = 0; i < n_rows; i++) {
+            const auto code = static_cast<uint32_t>(BitPackingUtils::Unpack(packed_codes.data(), bits_per_code, i));
+            const DecodedEntry &entry = Lookup(code);
+            views[i] = std::string_view(decoded + entry.offset, entry.length);
+        }
+        return true;
+    }
+
+    bool DecompressOneView(size_t index, std::string_view &view) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOneView called before CompressAll/Benchmark");
+
+        const auto code = static_cast<uint32_t>(BitPackingUtils::Unpack(packed_codes.data(), bits_per_code, index));
+        const DecodedEntry &entry = Lookup(code);
+        view = std::string_view(reinterpret_cast<const char *>(decoded_dictionary.data()) + entry.offset, entry.length);
+        return true;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        size_t dictionary_strings_size = 0;
+        for (const size_t length: dictionary_lengths) {
+            dictionary_strings_size += length;
+        }
+        const size_t dictionary_lengths_size = BitPackingUtils::GetCompressedSize(dictionary_lengths);
+        const size_t data_codes_size = packed_codes.size() - BitPackingUtils::PACKING_PADDING;
+
+        return CompressedSizeInfo::DictionaryFSST(CalcSymbolTableSize(), dictionary_strings_size,
+                                                  dictionary_lengths_size, data_codes_size);
+    }
+
+    // the value is compressed with the symbol table and looked up among the compressed dictionary entries, FSST
+    // compresses equal strings to equal bytes. The codes of the matching entry are scanned
+    bool FilterEquals(const std::string_view value, std::vector<uint32_t> &rows) override {
+        if (!run_queries_) return false;
+
+        std::vector<uint8_t> compressed_value(2 * value.size() + 16);
+        size_t value_length = value.size();
+        const auto *value_pointer = reinterpret_cast<const unsigned char *>(value.data());
+        size_t compressed_length;
+        unsigned char *compressed_pointer;
+        if (fsst_compress(encoder, 1, &value_length, &value_pointer, compressed_value.size(), compressed_value.data(),
+                          &compressed_length, &compressed_pointer) == 0) {
+            // the value did not fit the buffer, it is compared with the decompressed strings instead
+            return false;
+        }
+
+        const auto it = compressed_codes.find(
+            std::string_view(reinterpret_cast<const char *>(compressed_pointer), compressed_length));
+        if (it == compressed_codes.end()) {
+            rows.clear();
+            return true;
+        }
+        const uint32_t code = it->second;
+        woven_codes.FilterRange(code, code, filter_bitmap);
+        WovenCodes::BitmapToRows(filter_bitmap, rows);
+        return true;
+    }
+
+    // a histogram of the codes, only the dictionary entries are decompressed
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        std::vector<uint32_t> codes(n_rows);
+        for (size_t i = 0; i < n_rows; i++) {
+            codes[i] = static_cast<uint32_t>(BitPackingUtils::Unpack(packed_codes.data(), bits_per_code, i));
+        }
+        std::vector<uint64_t> counts;
+        CodeQueries::Histogram(codes.data(), n_rows, decoded_entries.size(), counts);
+        groups.resize(counts.size());
+        for (size_t code = 0; code < counts.size(); code++) {
+            const DecodedEntry &entry = Lookup(static_cast<uint32_t>(code));
+            groups[code] = {
+                std::string_view(reinterpret_cast<const char *>(decoded_dictionary.data()) + entry.offset, entry.length),
+                counts[code]
+            };
+        }
+        return true;
+    }
+
+    // the buffers stay allocated, the entries are only marked as not decoded, so the next lookups decode them again
+    void ResetDecompressionCaches() override {
+        std::fill(decoded_entries.begin(), decoded_entries.end(), DecodedEntry{NOT_DECODED, 0});
+        decoded_dictionary_end = 0;
+    }
+
+    void Free() override {
+        free(compression_buffer);
+        fsst_destroy(encoder);
+        dictionary_lengths.clear();
+        dictionary_pointers.clear();
+        packed_codes.clear();
+        woven_codes.Clear();
+        compressed_codes.clear();
+        decoded_entries.clear();
+        decoded_dictionary.clear();
+    }
+
+private:
+    struct DecodedEntry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    static constexpr uint32_t NOT_DECODED = std::numeric_limits<uint32_t>::max();
+
+    // returns the decoded dictionary entry, decompressing it on the first lookup
+    inline const DecodedEntry &Lookup(const uint32_t code) {
+        DecodedEntry &entry = decoded_entries[code];
+        if (entry.offset == NOT_DECODED) {
+            entry.offset = static_cast<uint32_t>(decoded_dictionary_end);
+            entry.length = static_cast<uint32_t>(fsst_decompress(
+                &decoder,
+                dictionary_lengths[code],
+                dictionary_pointers[code],
+                decoded_dictionary.size() - decoded_dictionary_end,
+                decoded_dictionary.data() + decoded_dictionary_end
+            ));
+            decoded_dictionary_end += entry.length;
+        }
+        return entry;
+    }
+
+    [[nodiscard]] std::string_view CompressedEntry(const size_t code) const {
+        return {reinterpret_cast<const char *>(dictionary_pointers[code]), dictionary_lengths[code]};
+    }
+
+    [[nodiscard]] size_t CalcSymbolTableSize() const {
+        uint8_t header_buffer[FSST_MAXHEADER];
+        return fsst_export(encoder, header_buffer);
+    }
+
+    bool run_queries_{false};
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+
+    fsst_encoder_t *encoder{nullptr};
+    fsst_decoder_t decoder{};
+
+    // FSST compressed dictionary entries, in code order
+    idx_t compression_buffer_size{0};
+    uint8_t *compression_buffer{nullptr};
+    std::vector<size_t> dictionary_lengths;
+    std::vector<uint8_t *> dictionary_pointers;
+
+    // one bitpacked code per row
+    uint8_t bits_per_code{1};
+    std::vector<uint8_t> packed_codes;
+
+    // with the query phases: the code of every compressed dictionary entry, the codes again for filter scans, and the
+    // bitmap of the last filter
+    robin_hood::unordered_flat_map<std::string_view, uint32_t> compressed_codes;
+    WovenCodes woven_codes;
+    std::vector<uint64_t> filter_bitmap;
+
+    // decoded dictionary cache: entries are appended to decoded_dictionary on their first lookup
+    std::vector<DecodedEntry> decoded_entries;
+    std::vector<uint8_t> decoded_dictionary;
+    size_t decoded_dictionary_end{0};
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/huffman_coding.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Dictionary encoding whose codes are Huffman coded instead of bitpacked. The dictionary is ordered by frequency, the
+// HUFFMAN_MAX_SYMBOLS - 1 most frequent strings get a Huffman code, the rest an escape code followed by their
+// bitpacked code. Every ENTROPY_BLOCK_SIZE rows start at a known bit offset, full decompression decodes
+// ENTROPY_INTERLEAVED_STREAMS of these blocks at the same time
+class DictionaryHuffmanAlgorithm final : public ICompressionAlgorithm {
+public:
+    DictionaryHuffmanAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::DictionaryHuffman;
+    }
+
+    // the dictionary entries are the strings of the row group
+    [[nodiscard]] bool ReferencesInput() const override {
+        return true;
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        dictionary.clear();
+        dictionary_order.clear();
+
+        const auto pointers = data.GetPointers();
+        const auto lengths = data.GetLengths();
+        n_rows = data.Size();
+
+        std::vector<uint32_t> codes(n_rows);
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            std::vector<std::pair<const uint8_t *, size_t>> unique_strings;
+            std::vector<uint64_t> frequencies;
+            dictionary.reserve(n_rows / 10 + 1); // assume 10% unique strings
+            for (size_t i = 0; i < n_rows; i++) {
+                const std::string_view str_view(reinterpret_cast<const char *>(pointers[i]), lengths[i]);
+                auto [it, inserted] = dictionary.try_emplace(str_view, static_cast<uint32_t>(unique_strings.size()));
+                if (inserted) {
+                    unique_strings.emplace_back(pointers[i], lengths[i]);
+                    frequencies.push_back(0);
+                }
+                codes[i] = it->second;
+                frequencies[it->second]++;
+            }
+
+            // renumber the dictionary by descending frequency, so the frequent codes are the ones below the escape
+            std::vector<uint32_t> order(unique_strings.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+                return frequencies[a] > frequencies[b];
+            });
+            std::vector<uint32_t> renumbered(order.size());
+            dictionary_order.reserve(order.size());
+            for (uint32_t new_code = 0; new_code < order.size(); new_code++) {
+                renumbered[order[new_code]] = new_code;
+                dictionary_order.push_back(unique_strings[order[new_code]]);
+            }
+            for (auto &code: codes) {
+                code = renumbered[code];
+            }
+
+            bits_per_code = BitPackingUtils::GetBitsPerValue(dictionary_order.empty() ? 0 : dictionary_order.size() - 1);
+            std::vector<uint64_t> symbol_frequencies(std::min(dictionary_order.size(), HUFFMAN_MAX_SYMBOLS), 0);
+            for (const uint32_t code: codes) {
+                symbol_frequencies[std::min<uint32_t>(code, ESCAPE_SYMBOL)]++;
+            }
+            huffman.Build(symbol_frequencies, HUFFMAN_MAX_CODE_LENGTH);
+        }
+
+        auto timer = TimePhase(CompressionPhase::Encode);
+        BitWriter writer;
+        block_bit_offsets.clear();
+        for (size_t i = 0; i < n_rows; i++) {
+            if (i % ENTROPY_BLOCK_SIZE == 0) {
+                block_bit_offsets.push_back(writer.BitCount());
+            }
+            if (codes[i] < ESCAPE_SYMBOL) {
+                huffman.Encode(writer, codes[i]);
+            } else {
+                huffman.Encode(writer, ESCAPE_SYMBOL);
+                writer.Write(codes[i], bits_per_code);
+            }
+        }
+        n_bits = writer.BitCount();
+        encoded_codes = writer.Finish();
+        decoded_codes.resize(ENTROPY_INTERLEAVED_STREAMS * ENTROPY_BLOCK_SIZE);
+
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        uint8_t *write_ptr = out;
+        constexpr size_t group_size = ENTROPY_INTERLEAVED_STREAMS * ENTROPY_BLOCK_SIZE;
+        const size_t n_full_groups = n_rows / group_size;
+
+        for (size_t group_idx = 0; group_idx < n_full_groups; group_idx++) {
+            // one stream per block, decoded in lockstep so the table lookups of the streams overlap
+            size_t bit_positions[ENTROPY_INTERLEAVED_STREAMS];
+            for (size_t stream = 0; stream < ENTROPY_INTERLEAVED_STREAMS; stream++) {
+                bit_positions[stream] = block_bit_offsets[group_idx * ENTROPY_INTERLEAVED_STREAMS + stream];
+            }
+            for (size_t row = 0; row < ENTROPY_BLOCK_SIZE; row++) {
+                for (size_t stream = 0; stream < ENTROPY_INTERLEAVED_STREAMS; stream++) {
+                    decoded_codes[stream * ENTROPY_BLOCK_SIZE + row] = DecodeCode(bit_positions[stream]);
+                }
+            }
+            write_ptr = CopyStrings(decoded_codes.data(), group_size, write_ptr);
+        }
+
+        // the remaining rows as a single stream
+        if (n_full_groups * group_size == n_rows) {
+            return;
+        }
+        size_t bit_position = block_bit_offsets[n_full_groups * ENTROPY_INTERLEAVED_STREAMS];
+        for (size_t i = n_full_groups * group_size; i < n_rows; i++) {
+            const auto &[str_ptr, str_len] = dictionary_order[DecodeCode(bit_position)];
+            std::memcpy(write_ptr, str_ptr, str_len);
+            write_ptr += str_len;
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        // skip the rows of the block before the one asked for
+        size_t bit_position = block_bit_offsets[index / ENTROPY_BLOCK_SIZE];
+        for (size_t i = 0; i < index % ENTROPY_BLOCK_SIZE; i++) {
+            DecodeCode(bit_position);
+        }
+
+        const auto &[str_ptr, str_len] = dictionary_order[DecodeCode(bit_position)];
+        std::memcpy(out, str_ptr, str_len);
+        return str_len;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        size_t dictionary_strings_size = 0;
+        std::vector<size_t> dictionary_lengths;
+        for (const auto &[ptr, len]: dictionary_order) {
+            dictionary_strings_size += len;
+            dictionary_lengths.push_back(len);
+        }
+        // the Huffman code lengths belong to the dictionary
+        const size_t dictionary_lengths_size = BitPackingUtils::GetCompressedSize(dictionary_lengths) +
+                                               huffman.SizeInBytes();
+        // one Huffman code per row, the bit offsets of the blocks index the code stream
+        const size_t code_stream_size = (n_bits + 7) / 8;
+        const size_t block_offsets_size = BitPackingUtils::GetCompressedSize(n_bits, block_bit_offsets.size());
+        return CompressedSizeInfo::Dictionary(dictionary_strings_size, dictionary_lengths_size,
+                                              code_stream_size + block_offsets_size);
+    }
+
+    // the codes are Huffman decoded block by block into a histogram, no string is hashed
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        std::vector<uint32_t> codes(n_rows);
+        constexpr size_t group_size = ENTROPY_INTERLEAVED_STREAMS * ENTROPY_BLOCK_SIZE;
+        const size_t n_full_blocks = n_rows / group_size * ENTROPY_INTERLEAVED_STREAMS;
+        for (size_t block = 0; block < n_full_blocks; block++) {
+            size_t bit_position = block_bit_offsets[block];
+            for (size_t row = block * ENTROPY_BLOCK_SIZE; row < (block + 1) * ENTROPY_BLOCK_SIZE; row++) {
+                codes[row] = DecodeCode(bit_position);
+            }
+        }
+        // the remaining rows are a single stream
+        if (n_full_blocks * ENTROPY_BLOCK_SIZE < n_rows) {
+            size_t bit_position = block_bit_offsets[n_full_blocks];
+            for (size_t row = n_full_blocks * ENTROPY_BLOCK_SIZE; row < n_rows; row++) {
+                codes[row] = DecodeCode(bit_position);
+            }
+        }
+
+        std::vector<uint64_t> counts;
+        CodeQueries::Histogram(codes.data(), n_rows, dictionary_order.size(), counts);
+        groups.resize(counts.size());
+        for (size_t code = 0; code < counts.size(); code++) {
+            const auto &[str_ptr, str_len] = dictionary_order[code];
+            groups[code] = {std::string_view(reinterpret_cast<const char *>(str_ptr), str_len), counts[code]};
+        }
+        return true;
+    }
+
+    void Free() override {
+        dictionary.clear();
+        dictionary_order.clear();
+        encoded_codes.clear();
+        block_bit_offsets.clear();
+    }
+
+private:
+    static constexpr uint32_t ESCAPE_SYMBOL = HUFFMAN_MAX_SYMBOLS - 1;
+
+    inline uint32_t DecodeCode(size_t &bit_position) const {
+        const uint32_t symbol = huffman.Decode(encoded_codes.data(), bit_position);
+        if (symbol != ESCAPE_SYMBOL) {
+            return symbol;
+        }
+        const auto code = static_cast<uint32_t>(PeekBits(encoded_codes.data(), bit_position) &
+                                                ((uint64_t{1} << bits_per_code) - 1));
+        bit_position += bits_per_code;
+        return code;
+    }
+
+    inline uint8_t *CopyStrings(const uint32_t *codes, const size_t n, uint8_t *write_ptr) const {
+        for (size_t i = 0; i < n; i++) {
+            const auto &[str_ptr, str_len] = dictionary_order[codes[i]];
+            std::memcpy(write_ptr, str_ptr, str_len);
+            write_ptr += str_len;
+        }
+        return write_ptr;
+    }
+
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+
+    // Map from string to dictionary index, only needed while compressing
+    robin_hood::unordered_map<std::string_view, uint32_t> dictionary;
+
+    // Dictionary by descending frequency: stores (pointer, length) pairs
+    std::vector<std::pair<const uint8_t *, size_t>> dictionary_order;
+
+    HuffmanCode huffman;
+    uint8_t bits_per_code{1};
+    size_t n_bits{0};
+    std::vector<uint8_t> encoded_codes;
+    // bit offset of the first row of every block
+    std::vector<size_t> block_bit_offsets;
+
+    // codes of the blocks decoded together during full decompression
+    std::vector<uint32_t> decoded_codes;
+};
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/suffix_array_utils.hpp"
+
+// Experimental compressed self-index: an FM-index over the strings of the row group one after the other. The
+// Burrows-Wheeler transform (BWT) of the text is stored in a Huffman-shaped wavelet tree, so the index takes about as
+// many bits as the BWT Huffman coded, plus the samples. Substrings are found by backward search and located with the
+// suffix array sampled at every FM_INDEX_SA_SAMPLE_RATE-th text position, marked in a bit vector over the ranks, so
+// locating takes less LF steps than the sample rate. Rows are extracted by walking LF back from the rank of the next
+// sampled text position after the end of the row
+class FmIndexAlgorithm final : public ICompressionAlgorithm {
+public:
+    FmIndexAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::FMIndex;
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        return "sa_sample_rate=" + std::to_string(FM_INDEX_SA_SAMPLE_RATE);
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_ = data.TotalBytes();
+        row_offsets = data.GetOffsets();
+        const uint8_t *text = data.Data();
+
+        // the suffix array of the text with the sentinel suffix, which sorts first
+        std::vector<int32_t> suffix_array;
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            suffix_array = SuffixArray::Build(text, n_);
+            suffix_array.insert(suffix_array.begin(), static_cast<int32_t>(n_));
+        }
+
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            // the BWT holds the symbol before every suffix. The sentinel before the first suffix is stored as another
+            // symbol of the text, the ranks of that symbol after it are corrected
+            sentinel_placeholder = n_ == 0 ? 0 : text[0];
+            std::vector<uint8_t> bwt_symbols(n_ + 1);
+            std::vector<uint32_t> counts(256, 0);
+            for (size_t rank = 0; rank <= n_; rank++) {
+                if (suffix_array[rank] == 0) {
+                    sentinel_rank = rank;
+                    bwt_symbols[rank] = sentinel_placeholder;
+                } else {
+                    bwt_symbols[rank] = text[suffix_array[rank] - 1];
+                    counts[bwt_symbols[rank]]++;
+                }
+            }
+            bwt.Build(bwt_symbols.data(), bwt_symbols.size());
+
+            // the first rank of the suffixes starting with every symbol, after the sentinel suffix
+            symbol_starts.assign(257, 0);
+            symbol_starts[0] = 1;
+            for (size_t symbol = 0; symbol < 256; symbol++) {
+                symbol_starts[symbol + 1] = symbol_starts[symbol] + counts[symbol];
+            }
+        }
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        std::vector<uint64_t> sampled_words(n_ / 64 + 1, 0);
+        std::vector<uint32_t> sa_values;
+        std::vector<uint32_t> isa_values(n_ / FM_INDEX_SA_SAMPLE_RATE + 1);
+        sa_values.reserve(n_ / FM_INDEX_SA_SAMPLE_RATE + 1);
+        for (size_t rank = 0; rank <= n_; rank++) {
+            const auto position = static_cast<size_t>(suffix_array[rank]);
+            if (position % FM_INDEX_SA_SAMPLE_RATE == 0) {
+                sampled_words[rank / 64] |= uint64_t{1} << (rank % 64);
+                sa_values.push_back(static_cast<uint32_t>(position / FM_INDEX_SA_SAMPLE_RATE));
+                isa_values[position / FM_INDEX_SA_SAMPLE_RATE] = static_cast<uint32_t>(rank);
+            }
+        }
+        sampled_ranks.Build(std::move(sampled_words), n_ + 1);
+        sa_samples.Pack(sa_values, n_ / FM_INDEX_SA_SAMPLE_RATE);
+        isa_samples.Pack(isa_values, n_);
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        // the BWT is extracted and its LF mapping computed once, which is cheaper than an LF step in the wavelet tree
+        // for every symbol. The sentinel suffix is the first, LF walks the text from its end
+        std::vector<uint8_t> bwt_symbols(n_ + 1);
+        bwt.Extract(bwt_symbols.data(), bwt_symbols.size());
+        std::vector<uint32_t> lf(n_ + 1);
+        std::vector<uint32_t> next_ranks(symbol_starts.begin(), symbol_starts.end() - 1);
+        for (size_t rank = 0; rank <= n_; rank++) {
+            if (rank != sentinel_rank) {
+                lf[rank] = next_ranks[bwt_symbols[rank]]++;
+            }
+        }
+        size_t rank = 0;
+        for (size_t position = n_; position > 0; position--) {
+            out[position - 1] = bwt_symbols[rank];
+            rank = lf[rank];
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        const size_t start = row_offsets[index];
+        const size_t end = row_offsets[index + 1];
+        size_t position = std::min((end + FM_INDEX_SA_SAMPLE_RATE - 1) / FM_INDEX_SA_SAMPLE_RATE * FM_INDEX_SA_SAMPLE_RATE, n_);
+        size_t rank = position == n_ ? 0 : isa_samples.Get(position / FM_INDEX_SA_SAMPLE_RATE);
+        for (; position > end; position--) {
+            Step(rank);
+        }
+        for (; position > start; position--) {
+            out[position - 1 - start] = Step(rank);
+        }
+        return end - start;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        const size_t bwt_size = bwt.SizeInBytes() + symbol_starts.size() * sizeof(uint32_t);
+        const size_t samples_size = sampled_ranks.SizeInBytes() + sa_samples.SizeInBytes() + isa_samples.SizeInBytes();
+        std::vector<size_t> lengths(row_offsets.size() - 1);
+        for (size_t i = 0; i + 1 < row_offsets.size(); i++) {
+            lengths[i] = row_offsets[i + 1] - row_offsets[i];
+        }
+        return CompressedSizeInfo::FMIndex(bwt_size, samples_size, BitPackingUtils::GetCompressedSize(lengths));
+    }
+
+    // backward search for the needle, every occurrence is located and kept if it lies within one row. If locating
+    // them takes more LF steps than decompressing the text, it is decompressed and scanned instead
+    bool FilterContains(const std::string_view needle, std::vector<uint32_t> &rows) override {
+        rows.clear();
+        if (needle.empty()) {
+            rows.resize(row_offsets.size() - 1);
+            std::iota(rows.begin(), rows.end(), 0);
+            return true;
+        }
+        size_t begin = 0;
+        size_t end = n_ + 1;
+        for (size_t i = needle.size(); i > 0 && begin < end; i--) {
+            const auto symbol = static_cast<uint8_t>(needle[i - 1]);
+            begin = symbol_starts[symbol] + Occurrences(symbol, begin);
+            end = symbol_starts[symbol] + Occurrences(symbol, end);
+        }
+        if ((end - begin) * (FM_INDEX_SA_SAMPLE_RATE / 2) > n_) {
+            std::vector<uint8_t> text(GetDecompressionBufferSize(n_));
+            DecompressAll(text.data(), text.size());
+            for (size_t row = 0; row + 1 < row_offsets.size(); row++) {
+                if (memmem(text.data() + row_offsets[row], row_offsets[row + 1] - row_offsets[row], needle.data(),
+                           needle.size()) != nullptr) {
+                    rows.push_back(static_cast<uint32_t>(row));
+                }
+            }
+            return true;
+        }
+        for (size_t rank = begin; rank < end; rank++) {
+            const size_t position = Locate(rank);
+            const size_t row = std::upper_bound(row_offsets.begin(), row_offsets.end(), position) - row_offsets.begin() - 1;
+            if (position + needle.size() <= row_offsets[row + 1]) {
+                rows.push_back(static_cast<uint32_t>(row));
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        return true;
+    }
+
+    void Free() override {
+        row_offsets.clear();
+        symbol_starts.clear();
+        bwt.Clear();
+        sampled_ranks.Clear();
+        sa_samples.Clear();
+        isa_samples.Clear();
+    }
+
+private:
+    // bitpacked unsigned integers
+    struct PackedArray {
+        std::vector<uint8_t> packed;
+        uint8_t bits_per_value{1};
+        size_t size{0};
+
+        void Pack(const std::vector<uint32_t> &values, const uint64_t max_value) {
+            bits_per_value = BitPackingUtils::GetBitsPerValue(max_value);
+            packed = BitPackingUtils::Pack(values, bits_per_value);
+            size = values.size();
+        }
+
+        [[nodiscard]] size_t Get(const size_t index) const {
+            return BitPackingUtils::Unpack(packed.data(), bits_per_value, index);
+        }
+
+        [[nodiscard]] size_t SizeInBytes() const {
+            return (size * bits_per_value + 7) / 8;
+        }
+
+        void Clear() {
+            packed.clear();
+            size = 0;
+        }
+    };
+
+    // the symbol of the BWT at rank, which moves on to the rank of the suffix one position earlier in the text. Never
+    // called on the rank of the sentinel
+    inline uint8_t Step(size_t &rank) const {
+        size_t symbol_rank;
+        const uint8_t symbol = bwt.AccessRank(rank, symbol_rank);
+        if (symbol == sentinel_placeholder && rank > sentinel_rank) {
+            symbol_rank--;
+        }
+        rank = symbol_starts[symbol] + symbol_rank;
+        return symbol;
+    }
+
+    // the number of times symbol occurs in the BWT before rank
+    [[nodiscard]] size_t Occurrences(const uint8_t symbol, const size_t rank) const {
+        if (symbol_starts[symbol + 1] == symbol_starts[symbol]) {
+            return 0;
+        }
+        size_t occurrences = bwt.Rank(symbol, rank);
+        if (symbol == sentinel_placeholder && rank > sentinel_rank) {
+            occurrences--;
+        }
+        return occurrences;
+    }
+
+    // the text position of the suffix at rank, LF moves one position back until a sampled one. The first position is
+    // sampled, so the walk never reaches the sentinel
+    [[nodiscard]] size_t Locate(size_t rank) const {
+        size_t steps = 0;
+        while (!sampled_ranks.Get(rank)) {
+            Step(rank);
+            steps++;
+        }
+        return sa_samples.Get(sampled_ranks.Rank(rank)) * FM_INDEX_SA_SAMPLE_RATE + steps;
+    }
+
+    bool compressed_ready_{false};
+    size_t n_{0};
+    // where every row starts in the text, and where the last one ends
+    std::vector<size_t> row_offsets;
+
+    // the BWT, with the rank of the sentinel and the symbol stored in its place
+    HuffmanWaveletTree bwt;
+    size_t sentinel_rank{0};
+    uint8_t sentinel_placeholder{0};
+    // the first rank of the suffixes starting with every symbol, and of the ones after them
+    std::vector<uint32_t> symbol_starts;
+
+    // the ranks of the sampled text positions, their text positions divided by the sample rate in rank order, and the
+    // rank of every sampled text position
+    RankBitVector sampled_ranks;
+    PackedArray sa_samples;
+    PackedArray isa_samples;
+};
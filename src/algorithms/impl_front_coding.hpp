@@ -0,0 +1,244 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "fsst/fsst.h"
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/string_utils.hpp"
+
+// Front coding: every string stores the length of the prefix it shares with the previous string and the remaining
+// suffix. Every restart_interval strings the prefix is empty, so a row is decoded from the restart point before it.
+// Optionally the suffixes are compressed with FSST
+class FrontCodingAlgorithm final : public ICompressionAlgorithm {
+public:
+    explicit FrontCodingAlgorithm(const bool fsst_suffixes = false,
+                                  const size_t restart_interval = FRONT_CODING_RESTART_INTERVAL)
+        : fsst_suffixes_(fsst_suffixes), restart_interval_(std::max<size_t>(restart_interval, 1)) {
+    }
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return fsst_suffixes_ ? AlgorithType::FrontCodingFSST : AlgorithType::FrontCoding;
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        return "restart_interval=" + std::to_string(restart_interval_);
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        // FSST may expand a suffix, the raw suffixes are never larger than the input
+        compression_buffer_size = input.collector.TotalBytes() * 2 + 1000;
+        compression_buffer = static_cast<uint8_t *>(malloc(compression_buffer_size));
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_rows = data.Size();
+        const auto pointers = data.GetPointers();
+
+        std::vector<uint32_t> prefix_lengths(n_rows);
+        std::vector<size_t> suffix_lengths(n_rows);
+        std::vector<const unsigned char *> suffix_pointers(n_rows);
+        size_t max_string_length = 0;
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            for (size_t i = 0; i < n_rows; i++) {
+                const size_t length = pointers[i + 1] - pointers[i];
+                size_t prefix_length = 0;
+                if (i % restart_interval_ != 0) {
+                    prefix_length = CommonPrefixLength(pointers[i - 1], pointers[i] - pointers[i - 1], pointers[i], length);
+                }
+                prefix_lengths[i] = static_cast<uint32_t>(prefix_length);
+                suffix_lengths[i] = length - prefix_length;
+                suffix_pointers[i] = pointers[i] + prefix_length;
+                max_string_length = std::max(max_string_length, length);
+            }
+        }
+
+        std::vector<size_t> stored_suffix_lengths(n_rows);
+        if (fsst_suffixes_) {
+            EncodeSuffixesFsst(suffix_lengths, suffix_pointers, stored_suffix_lengths);
+        } else {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            uint8_t *write_ptr = compression_buffer;
+            for (size_t i = 0; i < n_rows; i++) {
+                std::memcpy(write_ptr, suffix_pointers[i], suffix_lengths[i]);
+                write_ptr += suffix_lengths[i];
+            }
+            stored_suffix_lengths = suffix_lengths;
+        }
+
+        auto timer = TimePhase(CompressionPhase::Encode);
+        restart_offsets.clear();
+        size_t suffix_offset = 0;
+        uint32_t max_prefix_length = 0;
+        size_t max_stored_suffix_length = 0;
+        for (size_t i = 0; i < n_rows; i++) {
+            if (i % restart_interval_ == 0) {
+                restart_offsets.push_back(static_cast<uint32_t>(suffix_offset));
+            }
+            suffix_offset += stored_suffix_lengths[i];
+            max_prefix_length = std::max(max_prefix_length, prefix_lengths[i]);
+            max_stored_suffix_length = std::max(max_stored_suffix_length, stored_suffix_lengths[i]);
+        }
+        suffix_data_size = suffix_offset;
+
+        prefix_bits = BitPackingUtils::GetBitsPerValue(max_prefix_length);
+        packed_prefix_lengths = BitPackingUtils::Pack(prefix_lengths, prefix_bits);
+        suffix_bits = BitPackingUtils::GetBitsPerValue(max_stored_suffix_length);
+        packed_suffix_lengths = BitPackingUtils::Pack(stored_suffix_lengths, suffix_bits);
+
+        // strings before a row are decoded into this buffer when it is accessed on its own
+        decode_buffer.resize(max_string_length + 32);
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        const uint8_t *suffix_ptr = compression_buffer;
+        uint8_t *write_ptr = out;
+        const uint8_t *previous_ptr = out;
+        for (size_t i = 0; i < n_rows; i++) {
+            // the previous string ends where this one starts and is at least as long as the prefix, no overlap
+            const size_t prefix_length = PrefixLength(i);
+            std::memcpy(write_ptr, previous_ptr, prefix_length);
+            previous_ptr = write_ptr;
+            write_ptr += prefix_length;
+
+            const size_t stored_suffix_length = StoredSuffixLength(i);
+            write_ptr += DecodeSuffix(suffix_ptr, stored_suffix_length, write_ptr,
+                                      out_capacity - (write_ptr - out));
+            suffix_ptr += stored_suffix_length;
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        const size_t restart_idx = index / restart_interval_;
+        const uint8_t *suffix_ptr = compression_buffer + restart_offsets[restart_idx];
+
+        // decode the strings from the restart point up to the one before the row, each on top of the previous one
+        for (size_t i = restart_idx * restart_interval_; i < index; i++) {
+            const size_t stored_suffix_length = StoredSuffixLength(i);
+            const size_t prefix_length = PrefixLength(i);
+            DecodeSuffix(suffix_ptr, stored_suffix_length, decode_buffer.data() + prefix_length,
+                         decode_buffer.size() - prefix_length);
+            suffix_ptr += stored_suffix_length;
+        }
+
+        const size_t prefix_length = PrefixLength(index);
+        std::memcpy(out, decode_buffer.data(), prefix_length);
+        return prefix_length + DecodeSuffix(suffix_ptr, StoredSuffixLength(index), out + prefix_length,
+                                            out_capacity - prefix_length);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        // the prefix and suffix lengths and the offset of every restart point
+        const size_t lengths_size = packed_prefix_lengths.size() + packed_suffix_lengths.size() -
+                                    2 * BitPackingUtils::PACKING_PADDING +
+                                    restart_offsets.size() * sizeof(uint32_t);
+        const size_t symbol_table_size = fsst_suffixes_ ? CalcSymbolTableSize() : 0;
+        return CompressedSizeInfo::FSST(symbol_table_size, suffix_data_size, lengths_size);
+    }
+
+    void Free() override {
+        free(compression_buffer);
+        compression_buffer = nullptr;
+        if (encoder != nullptr) {
+            fsst_destroy(encoder);
+            encoder = nullptr;
+        }
+        restart_offsets.clear();
+        packed_prefix_lengths.clear();
+        packed_suffix_lengths.clear();
+    }
+
+private:
+    void EncodeSuffixesFsst(const std::vector<size_t> &suffix_lengths, std::vector<const unsigned char *> &suffix_pointers,
+                            std::vector<size_t> &stored_suffix_lengths) {
+        fsst_sample_t *sample;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            sample = fsst_create_sample(n_rows, suffix_lengths.data(), suffix_pointers.data());
+        }
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            encoder = fsst_create_from_sample(sample, false, 1);
+            fsst_destroy_sample(sample);
+        }
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            std::vector<unsigned char *> stored_suffix_pointers(n_rows);
+            const size_t n_compressed = fsst_compress(
+                encoder,
+                n_rows,
+                suffix_lengths.data(),
+                suffix_pointers.data(),
+                compression_buffer_size,
+                compression_buffer,
+                stored_suffix_lengths.data(),
+                stored_suffix_pointers.data()
+            );
+            if (n_compressed != n_rows) {
+                ErrorHandler::HandleRuntimeError("Front coding ran out of buffer space compressing the suffixes");
+            }
+        }
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        decoder = fsst_decoder(encoder);
+    }
+
+    [[nodiscard]] inline size_t PrefixLength(const size_t index) const {
+        return BitPackingUtils::Unpack(packed_prefix_lengths.data(), prefix_bits, index);
+    }
+
+    [[nodiscard]] inline size_t StoredSuffixLength(const size_t index) const {
+        return BitPackingUtils::Unpack(packed_suffix_lengths.data(), suffix_bits, index);
+    }
+
+    // writes the suffix to out and returns its decoded length
+    inline size_t DecodeSuffix(const uint8_t *suffix, const size_t stored_length, uint8_t *out, const size_t out_capacity) {
+        if (!fsst_suffixes_) {
+            std::memcpy(out, suffix, stored_length);
+            return stored_length;
+        }
+        return fsst_decompress(&decoder, stored_length, suffix, out_capacity, out);
+    }
+
+    [[nodiscard]] size_t CalcSymbolTableSize() const {
+        uint8_t header_buffer[FSST_MAXHEADER];
+        return fsst_export(encoder, header_buffer);
+    }
+
+    bool fsst_suffixes_;
+    size_t restart_interval_;
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+
+    // the (FSST compressed) suffixes, one after the other
+    idx_t compression_buffer_size{0};
+    uint8_t *compression_buffer{nullptr};
+    size_t suffix_data_size{0};
+
+    // offset of the first suffix of every restart point
+    std::vector<uint32_t> restart_offsets;
+
+    uint8_t prefix_bits{1};
+    std::vector<uint8_t> packed_prefix_lengths;
+    // byte-lengths of the stored, i.e. possibly FSST compressed, suffixes
+    uint8_t suffix_bits{1};
+    std::vector<uint8_t> packed_suffix_lengths;
+
+    fsst_encoder_t *encoder{nullptr};
+    fsst_decoder_t decoder{};
+
+    std::vector<uint8_t> decode_buffer;
+};
@@ -1,25 +1,36 @@
 #pragma once
 
 #include <stdexcept>
+#include <thread>
 
 #include "fsst/fsst.h"
 #include "interface.hpp"
+#include "symbol_table_reuse.hpp"
 #include "../utils/bitpacking_utils.hpp"
 
 
 class FsstAlgorithm final : public ICompressionAlgorithm {
 public:
-    FsstAlgorithm() = default;
+    // with n_threads > 1 the symbol table is trained and the strings are encoded in parallel, the output is byte-identical.
+    // with reuse_symbol_table the row groups of a column are compressed with the table trained on an earlier row group
+    explicit FsstAlgorithm(const idx_t n_threads = 1, const bool reuse_symbol_table = false)
+        : n_threads_(std::max<idx_t>(n_threads, 1)), reuse_symbol_table_(reuse_symbol_table) {
+    }
 
     [[nodiscard]] AlgorithType GetAlgorithmType() const override {
-        return AlgorithType::FSST;
+        if (reuse_symbol_table_) return AlgorithType::FSSTReuse;
+        return n_threads_ > 1 ? AlgorithType::FSSTParallel : AlgorithType::FSST;
     }
 
     void Initialize(const ExperimentInput &input) override {
+        column_context_ = input.column_context;
+        row_group_idx_ = input.row_group_idx;
+
         compressed_lengths.resize(input.collector.Size());
         compressed_pointers.resize(input.collector.Size());
 
-        compression_buffer_size = input.collector.TotalBytes() * 2 + 1000;
+        // every thread encodes into its own area, each of them needs the slack
+        compression_buffer_size = input.collector.TotalBytes() * 2 + 1000 * n_threads_;
         compression_buffer = static_cast<uint8_t *>(malloc(compression_buffer_size));
     }
 
@@ -28,31 +39,229 @@ public:
     }
 
     void CompressAll(const StringCollector &data) override {
+        if (reuse_symbol_table_) {
+            CompressAllReusingSymbolTable(data);
+            return;
+        }
+        if (n_threads_ > 1) {
+            CompressAllParallel(data);
+            return;
+        }
+
         const StringCollector &collector = data;
-        encoder = fsst_create(
-            collector.Size(), /* IN: number of strings in batch to sample from. */
-            collector.GetLengths().data(), /* IN: byte-lengths of the inputs */
-            collector.GetPointers().data(), /* IN: string start pointers. */
-            false
-            /* IN: whether input strings are zero-terminated. If so, encoded strings are as well (i.e. symbol[0]=""). */
-        );
+        const auto lengths = collector.GetLengths();
+        auto pointers = collector.GetPointers();
 
-        fsst_compress(
-            encoder, /* IN: encoder obtained from fsst_create(). */
-            collector.Size(),
-            collector.GetLengths().data(), /* IN: byte-lengths of the inputs */
-            collector.GetPointers().data(),
-            compression_buffer_size, /* IN: byte-length of output buffer. */
-            compression_buffer, /* OUT: memory buffer to put the compressed strings in (one after the other). */
-            compressed_lengths.data(), /* OUT: byte-lengths of the compressed strings. */
-            compressed_pointers.data()
-            /* OUT: output string start pointers. Will all point into [output,output+size). */
-        );
+        encoder = CreateEncoder(collector.Size(), lengths.data(), pointers.data(), 1);
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            fsst_compress(
+                encoder, /* IN: encoder obtained from fsst_create(). */
+                collector.Size(),
+                lengths.data(), /* IN: byte-lengths of the inputs */
+                pointers.data(),
+                compression_buffer_size, /* IN: byte-length of output buffer. */
+                compression_buffer, /* OUT: memory buffer to put the compressed strings in (one after the other). */
+                compressed_lengths.data(), /* OUT: byte-lengths of the compressed strings. */
+                compressed_pointers.data()
+                /* OUT: output string start pointers. Will all point into [output,output+size). */
+            );
+        }
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        decoder = fsst_decoder(encoder);
+        compressed_ready_ = true;
+    }
+
+    // fsst_create() split up to time sampling and building the symbol table separately
+    fsst_encoder_t *CreateEncoder(const size_t n, const size_t *lengths, const unsigned char **pointers,
+                                  const unsigned int n_threads) {
+        fsst_sample_t *sample;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            sample = fsst_create_sample(n, lengths, pointers);
+        }
+        auto timer = TimePhase(CompressionPhase::Train);
+        fsst_encoder_t *created = fsst_create_from_sample(sample, false, n_threads);
+        fsst_destroy_sample(sample);
+        return created;
+    }
+
+    void CompressAllParallel(const StringCollector &collector) {
+        const auto lengths = collector.GetLengths();
+        auto pointers = collector.GetPointers();
+        const size_t n_strings = collector.Size();
+
+        encoder = CreateEncoder(n_strings, lengths.data(), pointers.data(), static_cast<unsigned int>(n_threads_));
+        EncodeParallel(lengths, pointers);
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        decoder = fsst_decoder(encoder);
+        compressed_ready_ = true;
+    }
+
+    void EncodeParallel(const std::vector<size_t> &lengths, std::vector<const unsigned char *> &pointers) {
+        auto timer = TimePhase(CompressionPhase::Encode);
+        const size_t n_strings = lengths.size();
+
+        // split the strings into disjoint ranges, each range is encoded into its own area of the compression buffer
+        const size_t strings_per_thread = (n_strings + n_threads_ - 1) / n_threads_;
+        std::vector<size_t> range_starts(n_threads_ + 1);
+        std::vector<uint8_t *> area_starts(n_threads_ + 1);
+        area_starts[0] = compression_buffer;
+        for (idx_t thread_idx = 0; thread_idx < n_threads_; thread_idx++) {
+            const size_t range_start = std::min(n_strings, thread_idx * strings_per_thread);
+            const size_t range_end = std::min(n_strings, range_start + strings_per_thread);
+            const size_t range_bytes = pointers[range_end] - pointers[range_start];
+            range_starts[thread_idx] = range_start;
+            range_starts[thread_idx + 1] = range_end;
+            area_starts[thread_idx + 1] = area_starts[thread_idx] + range_bytes * 2 + 1000;
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<size_t> n_compressed(n_threads_, 0);
+        for (idx_t thread_idx = 0; thread_idx < n_threads_; thread_idx++) {
+            threads.emplace_back([&, thread_idx]() {
+                const size_t range_start = range_starts[thread_idx];
+                const size_t range_size = range_starts[thread_idx + 1] - range_start;
+                if (range_size == 0) {
+                    return;
+                }
+                // every thread needs its own encoder instance for the SIMD staging buffer, the table is shared
+                fsst_encoder_t *thread_encoder = fsst_duplicate(encoder);
+                n_compressed[thread_idx] = fsst_compress(
+                    thread_encoder,
+                    range_size,
+                    lengths.data() + range_start,
+                    pointers.data() + range_start,
+                    area_starts[thread_idx + 1] - area_starts[thread_idx],
+                    area_starts[thread_idx],
+                    compressed_lengths.data() + range_start,
+                    compressed_pointers.data() + range_start
+                );
+                fsst_destroy(thread_encoder);
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        // stitch the areas together so the buffer looks exactly like the one of the serial encoder
+        uint8_t *write_ptr = compression_buffer;
+        for (idx_t thread_idx = 0; thread_idx < n_threads_; thread_idx++) {
+            const size_t range_start = range_starts[thread_idx];
+            const size_t range_end = range_starts[thread_idx + 1];
+            if (n_compressed[thread_idx] != range_end - range_start) {
+                ErrorHandler::HandleRuntimeError("FSST parallel compression ran out of output buffer space");
+            }
 
+            size_t area_size = 0;
+            for (size_t i = range_start; i < range_end; i++) {
+                area_size += compressed_lengths[i];
+            }
+
+            const uint8_t *area_start = area_starts[thread_idx];
+            if (area_start != write_ptr) {
+                std::memmove(write_ptr, area_start, area_size);
+                const ptrdiff_t shift = area_start - write_ptr;
+                for (size_t i = range_start; i < range_end; i++) {
+                    compressed_pointers[i] -= shift;
+                }
+            }
+            write_ptr += area_size;
+        }
+    }
+
+    void CompressAllReusingSymbolTable(const StringCollector &collector) {
+        const auto lengths = collector.GetLengths();
+        auto pointers = collector.GetPointers();
+
+        const auto train = [&]() {
+            shared_encoder_ = std::shared_ptr<void>(
+                CreateEncoder(collector.Size(), lengths.data(), pointers.data(), 1),
+                [](void *table) { fsst_destroy(static_cast<fsst_encoder_t *>(table)); }
+            );
+        };
+        const auto encode = [&]() {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            fsst_compress(
+                static_cast<fsst_encoder_t *>(shared_encoder_.get()),
+                collector.Size(),
+                lengths.data(),
+                pointers.data(),
+                compression_buffer_size,
+                compression_buffer,
+                compressed_lengths.data(),
+                compressed_pointers.data()
+            );
+        };
+
+        const TrainedSymbolTable *trained = SymbolTableReuse::Find(column_context_, GetAlgorithmType(), row_group_idx_);
+        if (trained != nullptr) {
+            shared_encoder_ = trained->table;
+        } else {
+            train();
+        }
+        encode();
+
+        // checking the table, storing it and creating the decoder are finalization, retraining is not
+        double escape_rate;
+        double compression_ratio;
+        const auto evaluate = [&]() {
+            auto timer = TimePhase(CompressionPhase::Finalize);
+            escape_rate = CalcEscapeRate();
+            compression_ratio = CalcDataCompressionRatio(collector);
+        };
+        evaluate();
+        if (trained != nullptr && SymbolTableReuse::NeedsRetraining(*trained, escape_rate, compression_ratio)) {
+            const double trained_compression_ratio = trained->trained_compression_ratio;
+            symbol_table_reuse_.retrained = true;
+            symbol_table_reuse_.ratio_drift = compression_ratio / trained_compression_ratio - 1.0;
+            train();
+            encode();
+            evaluate();
+        } else if (trained != nullptr) {
+            symbol_table_reuse_.reused = true;
+            symbol_table_reuse_.ratio_drift = compression_ratio / trained->trained_compression_ratio - 1.0;
+        }
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        symbol_table_reuse_.escape_rate = escape_rate;
+
+        if (!symbol_table_reuse_.reused) {
+            SymbolTableReuse::Store(column_context_, GetAlgorithmType(), row_group_idx_, shared_encoder_, compression_ratio);
+        }
+
+        encoder = static_cast<fsst_encoder_t *>(shared_encoder_.get());
         decoder = fsst_decoder(encoder);
         compressed_ready_ = true;
     }
 
+    // fraction of the codes that are escaped bytes (code FSST_ESC followed by the literal byte)
+    [[nodiscard]] double CalcEscapeRate() const {
+        size_t n_codes = 0;
+        size_t n_escapes = 0;
+        for (size_t index = 0; index < compressed_lengths.size(); index++) {
+            const uint8_t *codes = compressed_pointers[index];
+            for (size_t pos = 0; pos < compressed_lengths[index]; n_codes++) {
+                if (codes[pos] == FSST_ESC) {
+                    n_escapes++;
+                    pos += 2;
+                } else {
+                    pos += 1;
+                }
+            }
+        }
+        return n_codes == 0 ? 0.0 : static_cast<double>(n_escapes) / static_cast<double>(n_codes);
+    }
+
+    [[nodiscard]] double CalcDataCompressionRatio(const StringCollector &collector) const {
+        size_t data_codes_size = 0;
+        for (const size_t encoded_string_length: compressed_lengths) {
+            data_codes_size += encoded_string_length;
+        }
+        return data_codes_size == 0 ? 1.0 : static_cast<double>(collector.TotalBytes()) / static_cast<double>(data_codes_size);
+    }
+
     inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
         if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
         unsigned char *decompression_write_pointer = out;
@@ -97,20 +306,38 @@ public:
 
         // add the size to store the compressed lengths
         const size_t size_compressed_lengths = BitPackingUtils::GetCompressedSize(compressed_lengths);
-        const idx_t symbol_table_size = CalcSymbolTableSize(encoder);
+        // a reused symbol table is stored once per column, by the row group that trained it
+        const idx_t symbol_table_size = symbol_table_reuse_.reused ? 0 : CalcSymbolTableSize(encoder);
 
         return CompressedSizeInfo::FSST(symbol_table_size, data_codes_size, size_compressed_lengths);
 
     }
 
+    // all rows are encoded with one symbol table and encoding is deterministic, equal strings have equal FSST bytes
+    bool CompressedKeys(std::vector<std::string_view> &keys) override {
+        keys.resize(compressed_lengths.size());
+        for (size_t index = 0; index < compressed_lengths.size(); index++) {
+            keys[index] = std::string_view(reinterpret_cast<const char *>(compressed_pointers[index]), compressed_lengths[index]);
+        }
+        return true;
+    }
+
     void Free() override {
         free(compression_buffer);
-        fsst_destroy(encoder);
+        if (shared_encoder_) {
+            // the column context may still hold on to the symbol table
+            shared_encoder_.reset();
+        } else {
+            fsst_destroy(encoder);
+        }
     }
 
 private:
+    idx_t n_threads_;
+    bool reuse_symbol_table_;
     bool compressed_ready_{false};
     fsst_encoder_t *encoder;
+    std::shared_ptr<void> shared_encoder_;
     fsst_decoder_t decoder;
 
     // buffer for the compressed data
@@ -118,4 +345,7 @@ private:
     uint8_t *compression_buffer;
     std::vector<size_t> compressed_lengths;
     std::vector<uint8_t *> compressed_pointers;
+
+    ColumnContext *column_context_{nullptr};
+    size_t row_group_idx_{0};
 };
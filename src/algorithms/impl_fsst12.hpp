@@ -4,19 +4,25 @@
 
 #include "fsst12/fsst12.h"
 #include "interface.hpp"
+#include "symbol_table_reuse.hpp"
 #include "../utils/bitpacking_utils.hpp"
 
 
 
 class Fsst12Algorithm final : public ICompressionAlgorithm {
 public:
-    Fsst12Algorithm() = default;
+    // with reuse_symbol_table the row groups of a column are compressed with the table trained on an earlier row group
+    explicit Fsst12Algorithm(const bool reuse_symbol_table = false) : reuse_symbol_table_(reuse_symbol_table) {
+    }
 
     [[nodiscard]] AlgorithType GetAlgorithmType() const override {
-        return AlgorithType::FSST12;
+        return reuse_symbol_table_ ? AlgorithType::FSST12Reuse : AlgorithType::FSST12;
     }
 
     void Initialize(const ExperimentInput &input) override {
+        column_context_ = input.column_context;
+        row_group_idx_ = input.row_group_idx;
+
         compressed_lengths.resize(input.collector.Size());
         compressed_pointers.resize(input.collector.Size());
 
@@ -29,32 +35,146 @@ public:
     }
 
     void CompressAll(const StringCollector &data) override {
+        if (reuse_symbol_table_) {
+            CompressAllReusingSymbolTable(data);
+            return;
+        }
+
         const StringCollector &collector = data;
-        encoder = fsst12_create(
-            collector.Size(), /* IN: number of strings in batch to sample from. */
-            collector.GetLengths().data(), /* IN: byte-lengths of the inputs */
-            collector.GetPointers().data(), /* IN: string start pointers. */
-            false
-            /* IN: whether input strings are zero-terminated. If so, encoded strings are as well (i.e. symbol[0]=""). */
-        );
+        const auto lengths = collector.GetLengths();
+        auto pointers = collector.GetPointers();
 
-        fsst12_compress(
-            encoder, /* IN: encoder obtained from fsst12_create(). */
-            collector.Size(),
-            collector.GetLengths().data(), /* IN: byte-lengths of the inputs */
-            collector.GetPointers().data(),
-            compression_buffer_size, /* IN: byte-length of output buffer. */
-            compression_buffer, /* OUT: memory buffer to put the compressed strings in (one after the other). */
-            compressed_lengths.data(), /* OUT: byte-lengths of the compressed strings. */
-            compressed_pointers.data()
-            /* OUT: output string start pointers. Will all point into [output,output+size). */
-        );
+        encoder = CreateEncoder(collector.Size(), lengths.data(), pointers.data());
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            fsst12_compress(
+                encoder, /* IN: encoder obtained from fsst12_create(). */
+                collector.Size(),
+                lengths.data(), /* IN: byte-lengths of the inputs */
+                pointers.data(),
+                compression_buffer_size, /* IN: byte-length of output buffer. */
+                compression_buffer, /* OUT: memory buffer to put the compressed strings in (one after the other). */
+                compressed_lengths.data(), /* OUT: byte-lengths of the compressed strings. */
+                compressed_pointers.data()
+                /* OUT: output string start pointers. Will all point into [output,output+size). */
+            );
+        }
 
+        auto timer = TimePhase(CompressionPhase::Finalize);
         decoder = fsst12_decoder(encoder);
 
         compressed_ready_ = true;
     }
 
+    // fsst12_create() split up to time sampling and building the symbol table separately
+    fsst12_encoder_t *CreateEncoder(const size_t n, const size_t *lengths, const unsigned char **pointers) {
+        fsst12_sample_t *sample;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            sample = fsst12_create_sample(n, lengths, pointers);
+        }
+        auto timer = TimePhase(CompressionPhase::Train);
+        fsst12_encoder_t *created = fsst12_create_from_sample(sample);
+        fsst12_destroy_sample(sample);
+        return created;
+    }
+
+    void CompressAllReusingSymbolTable(const StringCollector &collector) {
+        const auto lengths = collector.GetLengths();
+        auto pointers = collector.GetPointers();
+
+        const auto train = [&]() {
+            shared_encoder_ = std::shared_ptr<void>(
+                CreateEncoder(collector.Size(), lengths.data(), pointers.data()),
+                [](void *table) { fsst12_destroy(static_cast<fsst12_encoder_t *>(table)); }
+            );
+        };
+        const auto encode = [&]() {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            fsst12_compress(
+                static_cast<fsst12_encoder_t *>(shared_encoder_.get()),
+                collector.Size(),
+                lengths.data(),
+                pointers.data(),
+                compression_buffer_size,
+                compression_buffer,
+                compressed_lengths.data(),
+                compressed_pointers.data()
+            );
+        };
+
+        const TrainedSymbolTable *trained = SymbolTableReuse::Find(column_context_, GetAlgorithmType(), row_group_idx_);
+        if (trained != nullptr) {
+            shared_encoder_ = trained->table;
+        } else {
+            train();
+        }
+        encode();
+
+        // checking the table, storing it and creating the decoder are finalization, retraining is not
+        double escape_rate;
+        double compression_ratio;
+        const auto evaluate = [&]() {
+            auto timer = TimePhase(CompressionPhase::Finalize);
+            escape_rate = CalcEscapeRate();
+            compression_ratio = CalcDataCompressionRatio(collector);
+        };
+        evaluate();
+        if (trained != nullptr && SymbolTableReuse::NeedsRetraining(*trained, escape_rate, compression_ratio)) {
+            const double trained_compression_ratio = trained->trained_compression_ratio;
+            symbol_table_reuse_.retrained = true;
+            symbol_table_reuse_.ratio_drift = compression_ratio / trained_compression_ratio - 1.0;
+            train();
+            encode();
+            evaluate();
+        } else if (trained != nullptr) {
+            symbol_table_reuse_.reused = true;
+            symbol_table_reuse_.ratio_drift = compression_ratio / trained->trained_compression_ratio - 1.0;
+        }
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        symbol_table_reuse_.escape_rate = escape_rate;
+
+        if (!symbol_table_reuse_.reused) {
+            SymbolTableReuse::Store(column_context_, GetAlgorithmType(), row_group_idx_, shared_encoder_, compression_ratio);
+        }
+
+        encoder = static_cast<fsst12_encoder_t *>(shared_encoder_.get());
+        decoder = fsst12_decoder(encoder);
+        compressed_ready_ = true;
+    }
+
+    // FSST12 has no escape code, the single-byte codes (< 256) play its role. Two 12-bit codes are packed into 3 bytes,
+    // a string with an odd number of codes ends with a single code in 2 bytes
+    [[nodiscard]] double CalcEscapeRate() const {
+        size_t n_codes = 0;
+        size_t n_escapes = 0;
+        for (size_t index = 0; index < compressed_lengths.size(); index++) {
+            const uint8_t *codes = compressed_pointers[index];
+            const size_t length = compressed_lengths[index];
+            size_t pos = 0;
+            for (; pos + 3 <= length; pos += 3) {
+                const uint32_t code0 = codes[pos] | ((codes[pos + 1] & 0xF) << 8);
+                const uint32_t code1 = (codes[pos + 1] >> 4) | (codes[pos + 2] << 4);
+                n_escapes += (code0 < 256) + (code1 < 256);
+                n_codes += 2;
+            }
+            if (pos + 2 == length) {
+                const uint32_t code = codes[pos] | ((codes[pos + 1] & 0xF) << 8);
+                n_escapes += code < 256;
+                n_codes += 1;
+            }
+        }
+        return n_codes == 0 ? 0.0 : static_cast<double>(n_escapes) / static_cast<double>(n_codes);
+    }
+
+    [[nodiscard]] double CalcDataCompressionRatio(const StringCollector &collector) const {
+        size_t data_codes_size = 0;
+        for (const size_t encoded_string_length: compressed_lengths) {
+            data_codes_size += encoded_string_length;
+        }
+        return data_codes_size == 0 ? 1.0 : static_cast<double>(collector.TotalBytes()) / static_cast<double>(data_codes_size);
+    }
+
     inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
         if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
         unsigned char *decompression_write_pointer = out;
@@ -99,19 +219,36 @@ public:
 
         // add the size to store the compressed lengths
         const size_t size_compressed_lengths = BitPackingUtils::GetCompressedSize(compressed_lengths);
-        const idx_t symbol_table_size = CalcSymbolTableSize(encoder);
+        // a reused symbol table is stored once per column, by the row group that trained it
+        const idx_t symbol_table_size = symbol_table_reuse_.reused ? 0 : CalcSymbolTableSize(encoder);
 
         return CompressedSizeInfo::FSST(symbol_table_size, data_codes_size, size_compressed_lengths);
     }
 
+    // all rows are encoded with one symbol table and encoding is deterministic, equal strings have equal FSST12 bytes
+    bool CompressedKeys(std::vector<std::string_view> &keys) override {
+        keys.resize(compressed_lengths.size());
+        for (size_t index = 0; index < compressed_lengths.size(); index++) {
+            keys[index] = std::string_view(reinterpret_cast<const char *>(compressed_pointers[index]), compressed_lengths[index]);
+        }
+        return true;
+    }
+
     void Free() override {
         free(compression_buffer);
-        fsst12_destroy(encoder);
+        if (shared_encoder_) {
+            // the column context may still hold on to the symbol table
+            shared_encoder_.reset();
+        } else {
+            fsst12_destroy(encoder);
+        }
     }
 
 private:
+    bool reuse_symbol_table_;
     bool compressed_ready_{false};
     fsst12_encoder_t *encoder;
+    std::shared_ptr<void> shared_encoder_;
     fsst12_decoder_t decoder;
 
     // buffer for the compressed data
@@ -119,4 +256,7 @@ private:
     uint8_t *compression_buffer;
     std::vector<size_t> compressed_lengths;
     std::vector<uint8_t *> compressed_pointers;
+
+    ColumnContext *column_context_{nullptr};
+    size_t row_group_idx_{0};
 };
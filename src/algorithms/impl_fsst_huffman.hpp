@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "fsst/fsst.h"
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/huffman_coding.hpp"
+
+// FSST whose code bytes are Huffman coded. The FSST compressed lengths are kept, every ENTROPY_BLOCK_SIZE strings
+// start at a known bit offset. Full decompression decodes the code bytes of ENTROPY_INTERLEAVED_STREAMS blocks at
+// the same time before FSST decodes the strings
+class FsstHuffmanAlgorithm final : public ICompressionAlgorithm {
+public:
+    FsstHuffmanAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::FSSTHuffman;
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        compressed_lengths.resize(input.collector.Size());
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_rows = data.Size();
+        const auto lengths = data.GetLengths();
+        auto pointers = data.GetPointers();
+
+        fsst_sample_t *sample;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            sample = fsst_create_sample(n_rows, lengths.data(), pointers.data());
+        }
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            encoder = fsst_create_from_sample(sample, false, 1);
+            fsst_destroy_sample(sample);
+        }
+
+        // the FSST codes are only an intermediate result, they are not kept
+        std::vector<uint8_t> fsst_codes(data.TotalBytes() * 2 + 1000);
+        std::vector<unsigned char *> compressed_pointers(n_rows);
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            fsst_compress(encoder, n_rows, lengths.data(), pointers.data(), fsst_codes.size(), fsst_codes.data(),
+                          compressed_lengths.data(), compressed_pointers.data());
+        }
+
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            std::vector<uint64_t> frequencies(256, 0);
+            for (size_t i = 0; i < n_rows; i++) {
+                for (size_t pos = 0; pos < compressed_lengths[i]; pos++) {
+                    frequencies[compressed_pointers[i][pos]]++;
+                }
+            }
+            huffman.Build(frequencies, HUFFMAN_MAX_CODE_LENGTH);
+        }
+
+        {
+            auto timer = TimePhase(CompressionPhase::Encode);
+            BitWriter writer;
+            block_bit_offsets.clear();
+            block_code_offsets.clear();
+            size_t n_codes = 0;
+            for (size_t i = 0; i < n_rows; i++) {
+                if (i % ENTROPY_BLOCK_SIZE == 0) {
+                    block_bit_offsets.push_back(writer.BitCount());
+                    block_code_offsets.push_back(n_codes);
+                }
+                for (size_t pos = 0; pos < compressed_lengths[i]; pos++) {
+                    huffman.Encode(writer, compressed_pointers[i][pos]);
+                }
+                n_codes += compressed_lengths[i];
+            }
+            block_code_offsets.push_back(n_codes);
+            n_bits = writer.BitCount();
+            encoded_codes = writer.Finish();
+        }
+
+        auto timer = TimePhase(CompressionPhase::Finalize);
+        decoder = fsst_decoder(encoder);
+        // full decompression decodes all code bytes into this buffer, random access only the ones of a block
+        decoded_codes.resize(block_code_offsets.back() + 8);
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        const size_t n_blocks = block_bit_offsets.size();
+        const size_t n_full_groups = n_blocks / ENTROPY_INTERLEAVED_STREAMS;
+        for (size_t group_idx = 0; group_idx < n_full_groups; group_idx++) {
+            // one stream per block, decoded in lockstep as long as all of them have codes left
+            const size_t first_block = group_idx * ENTROPY_INTERLEAVED_STREAMS;
+            size_t bit_positions[ENTROPY_INTERLEAVED_STREAMS];
+            uint8_t *write_ptrs[ENTROPY_INTERLEAVED_STREAMS];
+            size_t n_lockstep = SIZE_MAX;
+            for (size_t stream = 0; stream < ENTROPY_INTERLEAVED_STREAMS; stream++) {
+                const size_t block_idx = first_block + stream;
+                bit_positions[stream] = block_bit_offsets[block_idx];
+                write_ptrs[stream] = decoded_codes.data() + block_code_offsets[block_idx];
+                n_lockstep = std::min(n_lockstep, block_code_offsets[block_idx + 1] - block_code_offsets[block_idx]);
+            }
+            for (size_t pos = 0; pos < n_lockstep; pos++) {
+                for (size_t stream = 0; stream < ENTROPY_INTERLEAVED_STREAMS; stream++) {
+                    write_ptrs[stream][pos] = static_cast<uint8_t>(huffman.Decode(encoded_codes.data(), bit_positions[stream]));
+                }
+            }
+            for (size_t stream = 0; stream < ENTROPY_INTERLEAVED_STREAMS; stream++) {
+                const size_t block_idx = first_block + stream;
+                const size_t n_codes = block_code_offsets[block_idx + 1] - block_code_offsets[block_idx];
+                DecodeCodes(bit_positions[stream], n_codes - n_lockstep, write_ptrs[stream] + n_lockstep);
+            }
+        }
+        for (size_t block_idx = n_full_groups * ENTROPY_INTERLEAVED_STREAMS; block_idx < n_blocks; block_idx++) {
+            size_t bit_position = block_bit_offsets[block_idx];
+            DecodeCodes(bit_position, block_code_offsets[block_idx + 1] - block_code_offsets[block_idx],
+                        decoded_codes.data() + block_code_offsets[block_idx]);
+        }
+
+        const uint8_t *codes = decoded_codes.data();
+        uint8_t *write_ptr = out;
+        for (size_t i = 0; i < n_rows; i++) {
+            write_ptr += fsst_decompress(&decoder, compressed_lengths[i], codes, out_capacity - (write_ptr - out),
+                                         write_ptr);
+            codes += compressed_lengths[i];
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        // skip the codes of the strings of the block before the one asked for
+        const size_t block_idx = index / ENTROPY_BLOCK_SIZE;
+        size_t bit_position = block_bit_offsets[block_idx];
+        for (size_t i = block_idx * ENTROPY_BLOCK_SIZE; i < index; i++) {
+            for (size_t pos = 0; pos < compressed_lengths[i]; pos++) {
+                huffman.Decode(encoded_codes.data(), bit_position);
+            }
+        }
+
+        DecodeCodes(bit_position, compressed_lengths[index], decoded_codes.data());
+        return fsst_decompress(&decoder, compressed_lengths[index], decoded_codes.data(), out_capacity, out);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        // the Huffman code lengths belong to the symbol table
+        uint8_t header_buffer[FSST_MAXHEADER];
+        const size_t symbol_table_size = fsst_export(encoder, header_buffer) + huffman.SizeInBytes();
+        const size_t data_codes_size = (n_bits + 7) / 8;
+        const size_t data_lengths_size = BitPackingUtils::GetCompressedSize(compressed_lengths) +
+                                         BitPackingUtils::GetCompressedSize(n_bits, block_bit_offsets.size());
+        return CompressedSizeInfo::FSST(symbol_table_size, data_codes_size, data_lengths_size);
+    }
+
+    void Free() override {
+        fsst_destroy(encoder);
+        encoder = nullptr;
+        encoded_codes.clear();
+        block_bit_offsets.clear();
+        block_code_offsets.clear();
+        decoded_codes.clear();
+    }
+
+private:
+    inline void DecodeCodes(size_t &bit_position, const size_t n_codes, uint8_t *out) const {
+        for (size_t pos = 0; pos < n_codes; pos++) {
+            out[pos] = static_cast<uint8_t>(huffman.Decode(encoded_codes.data(), bit_position));
+        }
+    }
+
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+
+    fsst_encoder_t *encoder{nullptr};
+    fsst_decoder_t decoder{};
+    // number of FSST code bytes of every string
+    std::vector<size_t> compressed_lengths;
+
+    HuffmanCode huffman;
+    size_t n_bits{0};
+    std::vector<uint8_t> encoded_codes;
+    // bit offset and index of the first code byte of every block, the latter followed by the total number of codes
+    std::vector<size_t> block_bit_offsets;
+    std::vector<size_t> block_code_offsets;
+
+    std::vector<uint8_t> decoded_codes;
+};
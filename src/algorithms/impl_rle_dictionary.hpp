@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/cpu_features.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Run-length encoding over dictionary codes: consecutive rows with the same string form a run, stored as the code of
+// the string and the row the run ends at (exclusive). Decoding expands a run by filling its string repeatedly,
+// random access binary searches the run ends
+class RleDictionaryAlgorithm final : public ICompressionAlgorithm {
+public:
+    RleDictionaryAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::RLEDictionary;
+    }
+
+    // the dictionary entries are the strings of the row group
+    [[nodiscard]] bool ReferencesInput() const override {
+        return true;
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        dictionary.clear();
+        dictionary_order.clear();
+        run_values.clear();
+        run_ends.clear();
+
+        const auto pointers = data.GetPointers();
+        const auto lengths = data.GetLengths();
+
+        // the codes are assigned while the hash table is built, a run ends where the code changes
+        auto timer = TimePhase(CompressionPhase::Train);
+        dictionary.reserve(data.Size() / 10 + 1); // assume 10% unique strings
+        dictionary_order.reserve(data.Size() / 10 + 1);
+        for (size_t i = 0; i < data.Size(); i++) {
+            const std::string_view str_view(reinterpret_cast<const char *>(pointers[i]), lengths[i]);
+            auto [it, inserted] = dictionary.try_emplace(str_view, static_cast<uint32_t>(dictionary_order.size()));
+            if (inserted) {
+                dictionary_order.emplace_back(pointers[i], lengths[i]);
+            }
+
+            if (!run_values.empty() && run_values.back() == it->second) {
+                run_ends.back()++;
+            } else {
+                run_values.push_back(it->second);
+                run_ends.push_back(static_cast<uint32_t>(i + 1));
+            }
+        }
+
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        uint8_t *write_ptr = out;
+        uint32_t run_start = 0;
+        for (size_t run_idx = 0; run_idx < run_values.size(); run_idx++) {
+            const auto &[str_ptr, str_len] = dictionary_order[run_values[run_idx]];
+            const size_t run_length = run_ends[run_idx] - run_start;
+            FillRepeated(write_ptr, str_ptr, str_len, run_length);
+            write_ptr += str_len * run_length;
+            run_start = run_ends[run_idx];
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        // the first run that ends after the row holds it
+        const auto run = std::upper_bound(run_ends.begin(), run_ends.end(), static_cast<uint32_t>(index));
+        const auto &[str_ptr, str_len] = dictionary_order[run_values[run - run_ends.begin()]];
+
+        std::memcpy(out, str_ptr, str_len);
+        return str_len;
+    }
+
+    // every row of a run points at the same dictionary string
+    bool DecompressAllViews(std::string_view *views) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAllViews called before CompressAll/Benchmark");
+
+        uint32_t run_start = 0;
+        for (size_t run_idx = 0; run_idx < run_values.size(); run_idx++) {
+            const auto &[str_ptr, str_len] = dictionary_order[run_values[run_idx]];
+            std::fill(views + run_start, views + run_ends[run_idx],
+                      std::string_view(reinterpret_cast<const char *>(str_ptr), str_len));
+            run_start = run_ends[run_idx];
+        }
+        return true;
+    }
+
+    bool DecompressOneView(size_t index, std::string_view &view) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOneView called before CompressAll/Benchmark");
+
+        const auto run = std::upper_bound(run_ends.begin(), run_ends.end(), static_cast<uint32_t>(index));
+        const auto &[str_ptr, str_len] = dictionary_order[run_values[run - run_ends.begin()]];
+        view = std::string_view(reinterpret_cast<const char *>(str_ptr), str_len);
+        return true;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        size_t dictionary_strings_size = 0;
+        std::vector<size_t> dictionary_lengths;
+        for (const auto &[ptr, len]: dictionary_order) {
+            dictionary_strings_size += len;
+            dictionary_lengths.push_back(len);
+        }
+        const size_t dictionary_lengths_size = BitPackingUtils::GetCompressedSize(dictionary_lengths);
+
+        // run values and run ends are bitpacked
+        const size_t run_values_size = BitPackingUtils::GetCompressedSize(dictionary_order.size(), run_values.size());
+        const size_t run_ends_size = BitPackingUtils::GetCompressedSize(run_ends.empty() ? 0 : run_ends.back(),
+                                                                        run_ends.size());
+        return CompressedSizeInfo::RunLengthDictionary(dictionary_strings_size, dictionary_lengths_size,
+                                                       run_values_size, run_ends_size);
+    }
+
+    // every run adds its length to the count of its code
+    bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) override {
+        groups.resize(dictionary_order.size());
+        for (size_t code = 0; code < dictionary_order.size(); code++) {
+            const auto &[str_ptr, str_len] = dictionary_order[code];
+            groups[code] = {std::string_view(reinterpret_cast<const char *>(str_ptr), str_len), 0};
+        }
+        uint32_t run_start = 0;
+        for (size_t run_idx = 0; run_idx < run_values.size(); run_idx++) {
+            groups[run_values[run_idx]].second += run_ends[run_idx] - run_start;
+            run_start = run_ends[run_idx];
+        }
+        return true;
+    }
+
+    void Free() override {
+        dictionary.clear();
+        dictionary_order.clear();
+        run_values.clear();
+        run_ends.clear();
+    }
+
+private:
+    // writes the string count times to out. Single bytes are set with memset, strings of 2, 4 or 8 bytes are broadcast
+    // into an AVX2 register that is stored repeatedly if the CPU has AVX2, all others are copied in chunks that double
+    // in size
+    static inline void FillRepeated(uint8_t *out, const uint8_t *str, const size_t str_len, const size_t count) {
+        const size_t total = str_len * count;
+        if (total == 0) {
+            return;
+        }
+        if (str_len == 1) {
+            std::memset(out, str[0], count);
+            return;
+        }
+#if defined(CPU_FEATURES_X86)
+        if (total >= 32 && (str_len == 2 || str_len == 4 || str_len == 8) && CpuFeatures::HasAvx2()) {
+            FillPatternAvx2(out, str, str_len, total);
+            return;
+        }
+#endif
+        std::memcpy(out, str, str_len);
+        size_t filled = str_len;
+        while (filled < total) {
+            const size_t chunk = std::min(filled, total - filled);
+            std::memcpy(out + filled, out, chunk);
+            filled += chunk;
+        }
+    }
+
+#if defined(CPU_FEATURES_X86)
+    // total bytes of the string of 2, 4 or 8 bytes, at least 32
+    TARGET_AVX2 static void FillPatternAvx2(uint8_t *out, const uint8_t *str, const size_t str_len, const size_t total) {
+        __m256i pattern;
+        if (str_len == 2) {
+            uint16_t value;
+            std::memcpy(&value, str, sizeof(value));
+            pattern = _mm256_set1_epi16(static_cast<int16_t>(value));
+        } else if (str_len == 4) {
+            uint32_t value;
+            std::memcpy(&value, str, sizeof(value));
+            pattern = _mm256_set1_epi32(static_cast<int32_t>(value));
+        } else {
+            uint64_t value;
+            std::memcpy(&value, str, sizeof(value));
+            pattern = _mm256_set1_epi64x(static_cast<int64_t>(value));
+        }
+        size_t filled = 0;
+        for (; filled + 32 <= total; filled += 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + filled), pattern);
+        }
+        // the pattern repeats every 8 bytes, so the tail is its first bytes
+        uint8_t tail[32];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(tail), pattern);
+        std::memcpy(out + filled, tail, total - filled);
+    }
+#endif
+
+    bool compressed_ready_{false};
+
+    // Map from string to dictionary index, only needed while compressing
+    robin_hood::unordered_map<std::string_view, uint32_t> dictionary;
+
+    // Dictionary in insertion order: stores (pointer, length) pairs
+    std::vector<std::pair<const uint8_t *, size_t>> dictionary_order;
+
+    // per run the dictionary index of its string and the row after its last one
+    std::vector<uint32_t> run_values;
+    std::vector<uint32_t> run_ends;
+};
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "interface.hpp"
+#include "cascade.hpp"
+#include "templates.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/typed_strings.hpp"
+
+// The values of one slot of a template, in the order of the strings of the template
+struct TemplateSlot {
+    // the values as integers if they all are numbers without leading zeros or all numbers of width digits, otherwise
+    // as strings
+    std::unique_ptr<CascadeIntegers> numbers;
+    size_t width{0};
+    std::unique_ptr<CascadeStrings> strings;
+
+    inline size_t Get(const size_t rank, uint8_t *out, const size_t out_capacity) const {
+        if (numbers) {
+            return PrintNumber(numbers->Get(rank), out);
+        }
+        return strings->Get(rank, out, out_capacity);
+    }
+
+    inline size_t PrintNumber(uint32_t number, uint8_t *out) const {
+        if (width == 0) {
+            return TypedStringUtils::PrintInteger(number, out);
+        }
+        for (size_t digit = width; digit-- > 0;) {
+            out[digit] = static_cast<uint8_t>('0' + number % 10);
+            number /= 10;
+        }
+        return width;
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        return numbers ? numbers->SizeInBytes() : strings ? strings->SizeInBytes() : 0;
+    }
+
+    [[nodiscard]] size_t SymbolTablesSize() const {
+        return strings ? strings->SymbolTablesSize() : 0;
+    }
+};
+
+// Log lines, URLs and SQL text as templates with variable slots, e.g. GET /api/v1/user/{} took {} ms. The templates are
+// mined from a sample, every string is stored as the id of its template and the values of its slots. The values of a
+// slot of a template form a column, compressed by the cascade (raw, dictionary, RLE or FSST) or, if they are all
+// numbers, as a cascaded integer stream. Strings of no template are the single slot of a fallback template. A string
+// is found by the number of strings of its template before it, kept for every TEMPLATE_RANK_SAMPLE-th string
+class TemplateAlgorithm final : public ICompressionAlgorithm {
+public:
+    TemplateAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::Template;
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        return "max_templates=" + std::to_string(TEMPLATE_MAX_TEMPLATES);
+    }
+
+    [[nodiscard]] std::string GetChosenScheme() const override {
+        if (templates.empty()) {
+            return "";
+        }
+        return "templates=" + std::to_string(templates.size() - 1) + ";unmatched=" + std::to_string(template_counts.back());
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_rows = data.Size();
+        const auto pointers = data.GetPointers();
+
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            templates = TemplateUtils::Mine(DrawSample(pointers));
+            // the fallback template: the whole string is its slot
+            templates.push_back(LogTemplate{{"", ""}, ""});
+        }
+
+        // like Cascade, the time the compressor spends choosing schemes is the sample phase, the rest is encoding
+        CascadeCompressor compressor;
+        const auto start = std::chrono::high_resolution_clock::now();
+        Encode(pointers, compressor);
+        const auto end = std::chrono::high_resolution_clock::now();
+        const double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        compression_phase_times_.sample_ms += compressor.selection_ms;
+        compression_phase_times_.encode_ms += total_ms - compressor.selection_ms;
+
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        std::vector<uint32_t> ids(n_rows);
+        template_ids->DecodeAll(ids.data());
+
+        // every slot column is decoded once, numbers to their values and strings to their bytes and offsets
+        std::vector<std::vector<uint32_t>> numbers(slots.size());
+        std::vector<std::vector<uint8_t>> bytes(slots.size());
+        std::vector<std::vector<uint32_t>> offsets(slots.size());
+        std::vector<DecodedSlot> decoded(slots.size());
+        for (size_t slot_idx = 0; slot_idx < slots.size(); slot_idx++) {
+            const auto &slot = slots[slot_idx];
+            if (slot.numbers) {
+                numbers[slot_idx].resize(slot.numbers->n);
+                slot.numbers->DecodeAll(numbers[slot_idx].data());
+            } else if (slot.strings) {
+                bytes[slot_idx].resize(slot.strings->decoded_size + 32);
+                offsets[slot_idx].resize(slot.strings->n + 1, 0);
+                slot.strings->DecodeAll(bytes[slot_idx].data(), bytes[slot_idx].size(), offsets[slot_idx].data() + 1);
+                for (size_t i = 0; i < slot.strings->n; i++) {
+                    offsets[slot_idx][i + 1] += offsets[slot_idx][i];
+                }
+            }
+            decoded[slot_idx] = {&slot, numbers[slot_idx].data(), bytes[slot_idx].data(), offsets[slot_idx].data()};
+        }
+
+        // the literals of all templates one after the other, the ones of a template start at first_slot + its id
+        std::vector<uint8_t> literal_bytes;
+        std::vector<std::pair<uint32_t, uint32_t>> literal_spans;
+        for (const auto &log_template: templates) {
+            for (const auto &literal: log_template.literals) {
+                literal_spans.emplace_back(literal_bytes.size(), literal.size());
+                literal_bytes.insert(literal_bytes.end(), literal.begin(), literal.end());
+            }
+        }
+        literal_bytes.resize(literal_bytes.size() + 16);
+
+        std::vector<uint32_t> next_rank(templates.size(), 0);
+        uint8_t *write_ptr = out;
+        for (size_t row = 0; row < n_rows; row++) {
+            const uint32_t id = ids[row];
+            const uint32_t rank = next_rank[id]++;
+            const DecodedSlot *slot = decoded.data() + first_slot[id];
+            const std::pair<uint32_t, uint32_t> *literal = literal_spans.data() + first_slot[id] + id;
+            const size_t n_slots = templates[id].literals.size() - 1;
+            for (size_t slot_idx = 0; slot_idx < n_slots; slot_idx++) {
+                CopyShort(write_ptr, literal_bytes.data() + literal[slot_idx].first, literal[slot_idx].second);
+                write_ptr += literal[slot_idx].second;
+                if (slot[slot_idx].numbers != nullptr) {
+                    write_ptr += slot[slot_idx].slot->PrintNumber(slot[slot_idx].numbers[rank], write_ptr);
+                } else {
+                    const uint32_t start = slot[slot_idx].offsets[rank];
+                    const uint32_t length = slot[slot_idx].offsets[rank + 1] - start;
+                    CopyShort(write_ptr, slot[slot_idx].bytes + start, length);
+                    write_ptr += length;
+                }
+            }
+            CopyShort(write_ptr, literal_bytes.data() + literal[n_slots].first, literal[n_slots].second);
+            write_ptr += literal[n_slots].second;
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        // the rank of the string among the strings of its template: the sampled count plus the ones since the sample.
+        // It is not needed without slots, and it is the index if all strings are of the same template
+        const uint32_t id = template_ids->Get(index);
+        size_t rank = index;
+        if (templates[id].NSlots() > 0 && template_counts[id] != n_rows) {
+            uint32_t block_ids[TEMPLATE_RANK_SAMPLE];
+            const size_t n_before = index % TEMPLATE_RANK_SAMPLE;
+            template_ids->DecodeRange(index - n_before, n_before, block_ids);
+            rank = BitPackingUtils::Unpack(packed_ranks.data(), rank_bits,
+                                           index / TEMPLATE_RANK_SAMPLE * templates.size() + id);
+            for (size_t i = 0; i < n_before; i++) {
+                rank += block_ids[i] == id;
+            }
+        }
+
+        uint8_t *write_ptr = out;
+        const auto &literals = templates[id].literals;
+        for (size_t slot = 0; slot + 1 < literals.size(); slot++) {
+            std::memcpy(write_ptr, literals[slot].data(), literals[slot].size());
+            write_ptr += literals[slot].size();
+            write_ptr += slots[first_slot[id] + slot].Get(rank, write_ptr, out_capacity - (write_ptr - out));
+        }
+        std::memcpy(write_ptr, literals.back().data(), literals.back().size());
+        return write_ptr + literals.back().size() - out;
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        // every literal of a template is stored with a 16-bit length
+        size_t literals_size = 0;
+        size_t literal_lengths_size = 0;
+        for (const auto &log_template: templates) {
+            for (const auto &literal: log_template.literals) {
+                literals_size += literal.size();
+                literal_lengths_size += sizeof(uint16_t);
+            }
+        }
+        const size_t template_ids_size = template_ids->SizeInBytes() + packed_ranks.size() -
+                                         BitPackingUtils::PACKING_PADDING;
+        size_t symbol_tables_size = 0;
+        size_t slots_size = 0;
+        for (const auto &slot: slots) {
+            symbol_tables_size += slot.SymbolTablesSize();
+            slots_size += slot.SizeInBytes() - slot.SymbolTablesSize();
+        }
+        return CompressedSizeInfo::Template(literals_size, literal_lengths_size, symbol_tables_size,
+                                            template_ids_size, slots_size);
+    }
+
+    void Free() override {
+        templates.clear();
+        template_counts.clear();
+        template_ids.reset();
+        packed_ranks.clear();
+        slots.clear();
+        first_slot.clear();
+    }
+
+private:
+    // a decoded slot column, numbers if the slot has them and the bytes and offsets of the strings otherwise
+    struct DecodedSlot {
+        const TemplateSlot *slot;
+        const uint32_t *numbers;
+        const uint8_t *bytes;
+        const uint32_t *offsets;
+    };
+
+    // copies a string of up to 16 bytes as one 16-byte block, both buffers have at least that much slack
+    static inline void CopyShort(uint8_t *out, const uint8_t *in, const size_t length) {
+        if (length <= 16) {
+            std::memcpy(out, in, 16);
+        } else {
+            std::memcpy(out, in, length);
+        }
+    }
+
+    std::vector<std::string_view> DrawSample(const std::vector<const unsigned char *> &pointers) const {
+        std::vector<std::string_view> sample;
+        const size_t run_length = std::min(TEMPLATE_SAMPLE_RUN_LENGTH, n_rows);
+        const size_t stride = std::max<size_t>(n_rows / TEMPLATE_SAMPLE_RUNS, run_length);
+        for (size_t start = 0; start + run_length <= n_rows && sample.size() < TEMPLATE_SAMPLE_RUNS * run_length;
+             start += stride) {
+            for (size_t i = start; i < start + run_length; i++) {
+                sample.emplace_back(reinterpret_cast<const char *>(pointers[i]), pointers[i + 1] - pointers[i]);
+            }
+        }
+        return sample;
+    }
+
+    void Encode(const std::vector<const unsigned char *> &pointers, CascadeCompressor &compressor) {
+        robin_hood::unordered_flat_map<std::string, std::vector<uint32_t>> templates_by_skeleton;
+        size_t max_slots = 1;
+        for (uint32_t id = 0; id + 1 < templates.size(); id++) {
+            templates_by_skeleton[templates[id].skeleton].push_back(id);
+            max_slots = std::max(max_slots, templates[id].NSlots());
+        }
+        const auto fallback = static_cast<uint32_t>(templates.size() - 1);
+
+        // the values of every slot of every template and the number of strings of every template before every
+        // TEMPLATE_RANK_SAMPLE-th string
+        std::vector<std::vector<std::vector<std::string_view>>> values(templates.size());
+        for (size_t id = 0; id < templates.size(); id++) {
+            values[id].resize(templates[id].NSlots());
+        }
+        std::vector<uint32_t> ids(n_rows);
+        std::vector<uint32_t> counts(templates.size(), 0);
+        std::vector<uint32_t> ranks;
+        std::string skeleton;
+        std::vector<std::pair<uint32_t, uint32_t>> words;
+        std::vector<std::pair<uint32_t, uint32_t>> slot_bounds(max_slots);
+        for (size_t row = 0; row < n_rows; row++) {
+            if (row % TEMPLATE_RANK_SAMPLE == 0) {
+                ranks.insert(ranks.end(), counts.begin(), counts.end());
+            }
+            const uint8_t *str = pointers[row];
+            const size_t len = pointers[row + 1] - pointers[row];
+            TemplateUtils::Tokenize(str, len, skeleton, words);
+
+            uint32_t id = fallback;
+            if (const auto it = templates_by_skeleton.find(skeleton); it != templates_by_skeleton.end()) {
+                for (const uint32_t candidate: it->second) {
+                    if (TemplateUtils::Match(templates[candidate], str, len, slot_bounds.data())) {
+                        id = candidate;
+                        break;
+                    }
+                }
+            }
+            if (id == fallback) {
+                slot_bounds[0] = {0, static_cast<uint32_t>(len)};
+            }
+            for (size_t slot = 0; slot < templates[id].NSlots(); slot++) {
+                const auto [slot_start, slot_end] = slot_bounds[slot];
+                values[id][slot].emplace_back(reinterpret_cast<const char *>(str) + slot_start, slot_end - slot_start);
+            }
+            ids[row] = id;
+            counts[id]++;
+        }
+        template_counts = counts;
+
+        template_ids = compressor.CompressIntegers(ids, CASCADE_MAX_DEPTH);
+        rank_bits = BitPackingUtils::GetBitsPerValue(n_rows);
+        packed_ranks = BitPackingUtils::Pack(ranks, rank_bits);
+
+        slots.clear();
+        first_slot.clear();
+        std::vector<uint32_t> slot_numbers;
+        for (size_t id = 0; id < templates.size(); id++) {
+            first_slot.push_back(slots.size());
+            for (const auto &slot_values: values[id]) {
+                TemplateSlot slot;
+                if (slot_values.empty()) {
+                    // a template of the sample without strings in the row group
+                } else if (ParseNumbers(slot_values, slot_numbers, slot.width)) {
+                    slot.numbers = compressor.CompressIntegers(slot_numbers, CASCADE_MAX_DEPTH);
+                } else {
+                    slot.strings = compressor.CompressStrings(slot_values, CASCADE_MAX_DEPTH);
+                }
+                slots.push_back(std::move(slot));
+            }
+        }
+    }
+
+    // the values as numbers that fit 32 bits if they print back the same: all without leading zeros, or all with the
+    // same number of digits (e.g. the 05 of a month), which becomes the width
+    static bool ParseNumbers(const std::vector<std::string_view> &values, std::vector<uint32_t> &numbers, size_t &width) {
+        numbers.clear();
+        bool canonical = true;
+        bool same_width = true;
+        for (const auto value: values) {
+            const auto *digits = reinterpret_cast<const uint8_t *>(value.data());
+            if (value.empty() || value.size() > TypedStringUtils::MAX_INTEGER_DIGITS ||
+                !std::all_of(digits, digits + value.size(), TypedStringUtils::IsDigit)) {
+                return false;
+            }
+            canonical = canonical && (value.size() == 1 || value[0] != '0');
+            same_width = same_width && value.size() == values.front().size();
+            const int64_t number = TypedStringUtils::Digits(digits, value.size());
+            if ((!canonical && !same_width) || number > std::numeric_limits<uint32_t>::max()) {
+                return false;
+            }
+            numbers.push_back(static_cast<uint32_t>(number));
+        }
+        width = canonical ? 0 : values.front().size();
+        return true;
+    }
+
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+
+    // the mined templates, the last one is the fallback
+    std::vector<LogTemplate> templates;
+    // the number of strings of every template
+    std::vector<uint32_t> template_counts;
+    std::unique_ptr<CascadeIntegers> template_ids;
+    // per TEMPLATE_RANK_SAMPLE strings, the number of strings of every template before them
+    uint8_t rank_bits{1};
+    std::vector<uint8_t> packed_ranks;
+    // the slots of all templates, the ones of a template start at its first_slot
+    std::vector<TemplateSlot> slots;
+    std::vector<size_t> first_slot;
+};
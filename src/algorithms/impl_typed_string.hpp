@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "fsst/fsst.h"
+#include "interface.hpp"
+#include "../utils/bitpacking_utils.hpp"
+#include "../utils/typed_strings.hpp"
+
+// Strings that are really UUIDs, integers, decimals, timestamps, dates or IPv4 addresses stored as text. The format
+// most strings of the row group are in is detected, those strings are stored as binary values (UUIDs as 16 bytes, all
+// others as FOR bitpacked integers) and printed back on decompression. All other strings are exceptions, compressed
+// with FSST and found by their row
+class TypedStringAlgorithm final : public ICompressionAlgorithm {
+public:
+    TypedStringAlgorithm() = default;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        return AlgorithType::TypedString;
+    }
+
+    [[nodiscard]] std::string GetChosenScheme() const override {
+        const size_t n_exceptions = spec.format == StringFormat::None ? n_rows : exception_rows.size();
+        return spec.ToString() + ";exceptions=" + std::to_string(n_exceptions);
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+
+    }
+
+    idx_t GetDecompressionBufferSize(const idx_t decompressed_size) override {
+        return decompressed_size + 32; // Small offset for safety
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        n_rows = data.Size();
+        const auto pointers = data.GetPointers();
+        exception_rows.clear();
+        uuids.clear();
+        packed_values.clear();
+
+        {
+            auto timer = TimePhase(CompressionPhase::Train);
+            spec = DetectFormat(pointers, n_rows);
+        }
+
+        auto timer = TimePhase(CompressionPhase::Encode);
+        EncodeValues(pointers);
+        EncodeExceptions(pointers);
+        compressed_ready_ = true;
+    }
+
+    inline void DecompressAll(uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressAll called before CompressAll/Benchmark");
+
+        uint8_t *write_ptr = out;
+        size_t next_exception = 0;
+        for (size_t i = 0; i < n_rows; i++) {
+            if (IsException(i, next_exception)) {
+                write_ptr += DecompressException(next_exception++, write_ptr, out_capacity - (write_ptr - out));
+            } else {
+                write_ptr += PrintRow(i, write_ptr);
+            }
+        }
+    }
+
+    inline idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("DecompressOne called before CompressAll/Benchmark");
+
+        if (spec.format == StringFormat::None) {
+            return DecompressException(index, out, out_capacity);
+        }
+        const auto exception = std::lower_bound(exception_rows.begin(), exception_rows.end(), index);
+        if (exception != exception_rows.end() && *exception == index) {
+            return DecompressException(exception - exception_rows.begin(), out, out_capacity);
+        }
+        return PrintRow(index, out);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+
+        size_t symbol_table_size = 0;
+        if (encoder != nullptr) {
+            uint8_t header_buffer[FSST_MAXHEADER];
+            symbol_table_size = fsst_export(encoder, header_buffer);
+        }
+        size_t values_size = uuids.size();
+        if (!packed_values.empty()) {
+            values_size = sizeof(base) + packed_values.size() - BitPackingUtils::PACKING_PADDING;
+        }
+        // like FSST, the exceptions are stored by their compressed lengths, the offsets are their prefix sums
+        std::vector<uint32_t> exception_lengths(exception_offsets.size() - 1);
+        for (size_t i = 0; i + 1 < exception_offsets.size(); i++) {
+            exception_lengths[i] = exception_offsets[i + 1] - exception_offsets[i];
+        }
+        const size_t exception_index_size = BitPackingUtils::GetCompressedSize(n_rows, exception_rows.size()) +
+                                            BitPackingUtils::GetCompressedSize(exception_lengths);
+        return CompressedSizeInfo::TypedString(symbol_table_size, values_size, exception_offsets.back(),
+                                               exception_index_size);
+    }
+
+    void Free() override {
+        if (encoder != nullptr) {
+            fsst_destroy(encoder);
+            encoder = nullptr;
+        }
+        uuids.clear();
+        packed_values.clear();
+        exception_rows.clear();
+        exception_offsets.clear();
+        compressed_exceptions.clear();
+    }
+
+private:
+    // the format most strings are in, None if less than TYPED_STRING_MIN_MATCH_FRACTION of them are in one
+    static StringFormatSpec DetectFormat(const std::vector<const unsigned char *> &pointers, const size_t n) {
+        // strings in each variant of each format, decimals per scale
+        size_t integers = 0, uuids_lower = 0, uuids_upper = 0, timestamps_space = 0, timestamps_iso = 0, dates = 0,
+               addresses = 0;
+        std::array<size_t, TypedStringUtils::MAX_INTEGER_DIGITS + 1> decimals{};
+        int64_t value;
+
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *str = pointers[i];
+            const size_t len = pointers[i + 1] - pointers[i];
+            // the length alone rules out most formats
+            if (len == TypedStringUtils::UUID_LENGTH) {
+                uuids_lower += TypedStringUtils::ValidateUuid(str, false);
+                uuids_upper += TypedStringUtils::ValidateUuid(str, true);
+            } else if (len == TypedStringUtils::TIMESTAMP_LENGTH && (str[10] == ' ' || str[10] == 'T')) {
+                const bool is_timestamp = TypedStringUtils::ParseTimestamp(str, len, static_cast<char>(str[10]), value);
+                (str[10] == 'T' ? timestamps_iso : timestamps_space) += is_timestamp;
+            } else if (len == TypedStringUtils::DATE_LENGTH && str[4] == '-') {
+                dates += TypedStringUtils::ParseDate(str, len, value);
+            }
+            const int scale = TypedStringUtils::DecimalScale(str, len);
+            if (scale < 0) {
+                integers += TypedStringUtils::ParseInteger(str, len, value);
+            } else {
+                addresses += TypedStringUtils::ParseIPv4(str, len, value);
+                if (scale >= 1 && scale <= static_cast<int>(TypedStringUtils::MAX_INTEGER_DIGITS)) {
+                    decimals[scale] += TypedStringUtils::ParseDecimal(str, len, static_cast<uint8_t>(scale), value);
+                }
+            }
+        }
+
+        StringFormatSpec best;
+        size_t best_count = 0;
+        const auto consider = [&](const size_t count, const StringFormatSpec &candidate) {
+            if (count > best_count) {
+                best_count = count;
+                best = candidate;
+            }
+        };
+        consider(integers, {StringFormat::Integer});
+        for (size_t scale = 1; scale < decimals.size(); scale++) {
+            consider(decimals[scale], {StringFormat::Decimal, static_cast<uint8_t>(scale)});
+        }
+        consider(uuids_lower, {StringFormat::Uuid, 0, false});
+        consider(uuids_upper, {StringFormat::Uuid, 0, true});
+        consider(timestamps_space, {StringFormat::Timestamp, 0, false, ' '});
+        consider(timestamps_iso, {StringFormat::Timestamp, 0, false, 'T'});
+        consider(dates, {StringFormat::Date});
+        consider(addresses, {StringFormat::IPv4});
+
+        if (static_cast<double>(best_count) < TYPED_STRING_MIN_MATCH_FRACTION * static_cast<double>(n)) {
+            return {};
+        }
+        return best;
+    }
+
+    void EncodeValues(const std::vector<const unsigned char *> &pointers) {
+        if (spec.format == StringFormat::Uuid) {
+            uuids.resize(n_rows * TypedStringUtils::UUID_BYTES, 0);
+            for (size_t i = 0; i < n_rows; i++) {
+                if (!TypedStringUtils::ParseUuid(pointers[i], pointers[i + 1] - pointers[i], spec.uppercase,
+                                                 uuids.data() + i * TypedStringUtils::UUID_BYTES)) {
+                    exception_rows.push_back(i);
+                }
+            }
+            return;
+        }
+
+        std::vector<int64_t> values(n_rows, 0);
+        if (spec.format != StringFormat::None) {
+            for (size_t i = 0; i < n_rows; i++) {
+                if (!TypedStringUtils::ParseValue(spec, pointers[i], pointers[i + 1] - pointers[i], values[i])) {
+                    exception_rows.push_back(i);
+                }
+            }
+        }
+
+        // exceptions take the base, so they do not widen the range
+        int64_t min_value = INT64_MAX;
+        int64_t max_value = INT64_MIN;
+        size_t next_exception = 0;
+        for (size_t i = 0; i < n_rows; i++) {
+            if (next_exception < exception_rows.size() && exception_rows[next_exception] == i) {
+                next_exception++;
+                continue;
+            }
+            min_value = std::min(min_value, values[i]);
+            max_value = std::max(max_value, values[i]);
+        }
+        const bool has_values = exception_rows.size() < n_rows && spec.format != StringFormat::None;
+        if (!has_values || static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value) >= uint64_t{1} << 56) {
+            // nothing in the format, or a range too wide to bitpack: every string is an exception
+            spec = {};
+            exception_rows.clear();
+            return;
+        }
+
+        base = min_value;
+        std::vector<uint64_t> differences(n_rows, 0);
+        next_exception = 0;
+        for (size_t i = 0; i < n_rows; i++) {
+            if (next_exception < exception_rows.size() && exception_rows[next_exception] == i) {
+                next_exception++;
+                continue;
+            }
+            differences[i] = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(base);
+        }
+        bits = BitPackingUtils::GetBitsPerValue(static_cast<uint64_t>(max_value) - static_cast<uint64_t>(base));
+        packed_values = BitPackingUtils::Pack(differences, bits);
+    }
+
+    void EncodeExceptions(const std::vector<const unsigned char *> &pointers) {
+        exception_offsets.assign(1, 0);
+        compressed_exceptions.clear();
+        const size_t n_exceptions = spec.format == StringFormat::None ? n_rows : exception_rows.size();
+        if (n_exceptions == 0) {
+            return;
+        }
+
+        std::vector<size_t> lengths;
+        std::vector<const unsigned char *> exception_pointers;
+        size_t total_size = 0;
+        for (size_t exception_idx = 0; exception_idx < n_exceptions; exception_idx++) {
+            const size_t row = spec.format == StringFormat::None ? exception_idx : exception_rows[exception_idx];
+            lengths.push_back(pointers[row + 1] - pointers[row]);
+            exception_pointers.push_back(pointers[row]);
+            total_size += lengths.back();
+        }
+
+        encoder = fsst_create(lengths.size(), lengths.data(), exception_pointers.data(), 0);
+        compressed_exceptions.resize(total_size * 2 + 1000);
+        std::vector<size_t> compressed_lengths(lengths.size());
+        std::vector<unsigned char *> compressed_pointers(lengths.size());
+        fsst_compress(encoder, lengths.size(), lengths.data(), exception_pointers.data(), compressed_exceptions.size(),
+                      compressed_exceptions.data(), compressed_lengths.data(), compressed_pointers.data());
+        for (const size_t length: compressed_lengths) {
+            exception_offsets.push_back(exception_offsets.back() + length);
+        }
+        compressed_exceptions.resize(exception_offsets.back());
+        decoder = fsst_decoder(encoder);
+    }
+
+    // whether the row is the next exception, which all rows are if no format was found
+    inline bool IsException(const size_t row, const size_t next_exception) const {
+        return spec.format == StringFormat::None ||
+               (next_exception < exception_rows.size() && exception_rows[next_exception] == row);
+    }
+
+    inline size_t PrintRow(const size_t index, uint8_t *out) const {
+        if (spec.format == StringFormat::Uuid) {
+            return TypedStringUtils::PrintUuid(uuids.data() + index * TypedStringUtils::UUID_BYTES, spec.uppercase, out);
+        }
+        const auto difference = BitPackingUtils::Unpack(packed_values.data(), bits, index);
+        return TypedStringUtils::PrintValue(spec, static_cast<int64_t>(static_cast<uint64_t>(base) + difference), out);
+    }
+
+    inline size_t DecompressException(const size_t exception_idx, uint8_t *out, const size_t out_capacity) {
+        const uint32_t offset = exception_offsets[exception_idx];
+        return fsst_decompress(&decoder, exception_offsets[exception_idx + 1] - offset,
+                               compressed_exceptions.data() + offset, out_capacity, out);
+    }
+
+    bool compressed_ready_{false};
+    size_t n_rows{0};
+    StringFormatSpec spec;
+
+    // values of the strings in the format: 16 bytes per row for UUIDs, otherwise the bitpacked difference to base.
+    // Exceptions have a value as well, which is never printed
+    std::vector<uint8_t> uuids;
+    int64_t base{0};
+    uint8_t bits{1};
+    std::vector<uint8_t> packed_values;
+
+    // rows not in the format (not stored if no row is), their FSST compressed strings and where each of them starts
+    std::vector<uint32_t> exception_rows;
+    std::vector<uint32_t> exception_offsets;
+    std::vector<uint8_t> compressed_exceptions;
+    fsst_encoder_t *encoder{nullptr};
+    fsst_decoder_t decoder{};
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <memory>
+#include <zstd.h>
+#include <zdict.h>
+
+#include "block_compression.hpp"
+#include "symbol_table_reuse.hpp"
+
+// A zstd dictionary prepared for compression and decompression
+struct ZstdDictionary {
+    std::vector<uint8_t> content;
+    // the compression level cdict is digested for
+    int level{ZSTD_COMPRESSION_LEVEL};
+    ZSTD_CDict *cdict{nullptr};
+    ZSTD_DDict *ddict{nullptr};
+
+    ZstdDictionary() = default;
+    ZstdDictionary(const ZstdDictionary &) = delete;
+    ZstdDictionary &operator=(const ZstdDictionary &) = delete;
+
+    ~ZstdDictionary() {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+    }
+};
+
+class ZstdAlgorithm final : public BlockCompressionAlgorithm {
+public:
+    enum class DictionaryMode {
+        None,
+        // every row group trains its own dictionary
+        RowGroup,
+        // the first row group of a column trains the dictionary, the following ones reuse it
+        Column,
+    };
+
+    // of the block codec parameters the LZ4 ones do not apply
+    explicit ZstdAlgorithm(const DictionaryMode dictionary_mode = DictionaryMode::None,
+                           const BlockCodecParameters &parameters = {})
+        : BlockCompressionAlgorithm(parameters), dictionary_mode_(dictionary_mode), level_(parameters.zstd_level),
+          cctx_(ZSTD_createCCtx()), dctx_(ZSTD_createDCtx()) {
+    }
+
+    ~ZstdAlgorithm() override {
+        ZSTD_freeCCtx(cctx_);
+        ZSTD_freeDCtx(dctx_);
+    }
+
+    ZstdAlgorithm(const ZstdAlgorithm &) = delete;
+    ZstdAlgorithm &operator=(const ZstdAlgorithm &) = delete;
+
+    [[nodiscard]] AlgorithType GetAlgorithmType() const override {
+        switch (dictionary_mode_) {
+            case DictionaryMode::RowGroup: return AlgorithType::ZstdRowGroupDict;
+            case DictionaryMode::Column: return AlgorithType::ZstdColumnDict;
+            default: return AlgorithType::Zstd;
+        }
+    }
+
+    [[nodiscard]] std::string GetParameters() const override {
+        return GetBlockParameters() + ";level=" + std::to_string(level_);
+    }
+
+    void Initialize(const ExperimentInput &input) override {
+        BlockCompressionAlgorithm::Initialize(input);
+        column_context_ = input.column_context;
+        row_group_idx_ = input.row_group_idx;
+    }
+
+    void CompressAll(const StringCollector &data) override {
+        dictionary_.reset();
+        if (dictionary_mode_ != DictionaryMode::None) {
+            PrepareDictionary(data);
+        }
+
+        auto timer = TimePhase(CompressionPhase::Encode);
+        CompressBlocks(data);
+    }
+
+    CompressedSizeInfo CompressedSize() override {
+        if (!compressed_ready_) ErrorHandler::HandleLogicError("CompressedSize called before CompressAll/Benchmark");
+        size_t compressed_size_data;
+        size_t compressed_size_lengths;
+        CalcBlocksCompressedSize(compressed_size_data, compressed_size_lengths);
+
+        // a reused dictionary is stored once per column, by the row group that trained it
+        const size_t dictionary_size = dictionary_ && !symbol_table_reuse_.reused ? dictionary_->content.size() : 0;
+        return CompressedSizeInfo::BlockWithDictionary(dictionary_size, compressed_size_data, compressed_size_lengths);
+    }
+
+    void Free() override {
+        BlockCompressionAlgorithm::Free();
+        // the column context may still hold on to the dictionary
+        dictionary_.reset();
+    }
+
+protected:
+    [[nodiscard]] size_t CompressBound(const size_t input_size) const override {
+        return ZSTD_compressBound(input_size);
+    }
+
+    size_t CompressBlock(const uint8_t *in, const size_t in_size, uint8_t *out, const size_t out_capacity) override {
+        const size_t compressed_size = dictionary_
+                                           ? ZSTD_compress_usingCDict(cctx_, out, out_capacity, in, in_size,
+                                                                      dictionary_->cdict)
+                                           : ZSTD_compressCCtx(cctx_, out, out_capacity, in, in_size, level_);
+        if (ZSTD_isError(compressed_size)) {
+            ErrorHandler::HandleRuntimeError(std::string("Zstd compression failed: ") +
+                                             ZSTD_getErrorName(compressed_size));
+        }
+        return compressed_size;
+    }
+
+    size_t DecompressBlock(const Block &block, uint8_t *out, const size_t out_capacity) override {
+        const size_t decompressed_size = dictionary_
+                                             ? ZSTD_decompress_usingDDict(dctx_, out, out_capacity,
+                                                                          block.compressed_data,
+                                                                          block.compressed_data_size,
+                                                                          dictionary_->ddict)
+                                             : ZSTD_decompressDCtx(dctx_, out, out_capacity, block.compressed_data,
+                                                                   block.compressed_data_size);
+        if (ZSTD_isError(decompressed_size)) {
+            ErrorHandler::HandleRuntimeError(std::string("Zstd decompression failed: ") +
+                                             ZSTD_getErrorName(decompressed_size));
+        }
+        return decompressed_size;
+    }
+
+private:
+    void PrepareDictionary(const StringCollector &data) {
+        if (dictionary_mode_ == DictionaryMode::Column) {
+            const TrainedSymbolTable *trained = SymbolTableReuse::Find(column_context_, GetAlgorithmType(), row_group_idx_);
+            if (trained != nullptr) {
+                dictionary_ = std::static_pointer_cast<ZstdDictionary>(trained->table);
+                symbol_table_reuse_.reused = true;
+                if (dictionary_->level != level_) {
+                    // trained by a run at another level, the compression dictionary is digested for that level
+                    auto timer = TimePhase(CompressionPhase::Train);
+                    dictionary_ = CreateDictionary(dictionary_->content);
+                }
+                return;
+            }
+        }
+
+        std::vector<uint8_t> sample;
+        std::vector<size_t> sample_sizes;
+        {
+            auto timer = TimePhase(CompressionPhase::Sample);
+            DrawSample(data, sample, sample_sizes);
+        }
+
+        auto timer = TimePhase(CompressionPhase::Train);
+        std::vector<uint8_t> content(ZSTD_DICTIONARY_CAPACITY);
+        const size_t dictionary_size = ZDICT_trainFromBuffer(
+            content.data(), content.size(),
+            sample.data(), sample_sizes.data(), static_cast<unsigned>(sample_sizes.size())
+        );
+        if (ZDICT_isError(dictionary_size)) {
+            // too few or too uniform strings to train on, the blocks are compressed without a dictionary
+            return;
+        }
+        content.resize(dictionary_size);
+        dictionary_ = CreateDictionary(content);
+
+        if (dictionary_mode_ == DictionaryMode::Column) {
+            SymbolTableReuse::Store(column_context_, GetAlgorithmType(), row_group_idx_, dictionary_, 0.0);
+        }
+    }
+
+    [[nodiscard]] std::shared_ptr<ZstdDictionary> CreateDictionary(const std::vector<uint8_t> &content) const {
+        auto dictionary = std::make_shared<ZstdDictionary>();
+        dictionary->content = content;
+        dictionary->level = level_;
+        dictionary->cdict = ZSTD_createCDict(dictionary->content.data(), dictionary->content.size(), level_);
+        dictionary->ddict = ZSTD_createDDict(dictionary->content.data(), dictionary->content.size());
+        return dictionary;
+    }
+
+    // every string is a training sample, taken from evenly spaced vectors until the sample size is reached
+    static void DrawSample(const StringCollector &data, std::vector<uint8_t> &sample, std::vector<size_t> &sample_sizes) {
+        const auto pointers = data.GetPointers();
+        const size_t n_vectors = (data.Size() + VECTOR_SIZE - 1) / VECTOR_SIZE;
+        const size_t vector_stride = std::max<size_t>(1, data.TotalBytes() / ZSTD_DICTIONARY_SAMPLE_SIZE);
+
+        for (size_t vector_idx = 0; vector_idx < n_vectors; vector_idx += vector_stride) {
+            const size_t start = vector_idx * VECTOR_SIZE;
+            const size_t end = std::min(data.Size(), start + VECTOR_SIZE);
+            // the strings of a vector are stored contiguously
+            sample.insert(sample.end(), pointers[start], pointers[end]);
+            for (size_t i = start; i < end; i++) {
+                sample_sizes.push_back(pointers[i + 1] - pointers[i]);
+            }
+        }
+    }
+
+    DictionaryMode dictionary_mode_;
+    int level_;
+    ZSTD_CCtx *cctx_;
+    ZSTD_DCtx *dctx_;
+    std::shared_ptr<ZstdDictionary> dictionary_;
+
+    ColumnContext *column_context_{nullptr};
+    size_t row_group_idx_{0};
+};
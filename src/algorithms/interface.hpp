@@ -1,6 +1,32 @@
 #pragma once
+#include <algorithm>
+#include <random>
+#include "queries.hpp"
 #include "../models/benchmark_config.hpp"
+#include "../utils/bitweaving_utils.hpp"
 #include "../utils/error_handler.hpp"
+#include "../utils/synopsis_utils.hpp"
+
+
+// Adds the time until it goes out of scope to the time of a compression phase
+class PhaseTimer {
+public:
+    explicit PhaseTimer(double &phase_time_ms)
+        : phase_time_ms_(phase_time_ms), start_(std::chrono::high_resolution_clock::now()) {
+    }
+
+    ~PhaseTimer() {
+        const auto end = std::chrono::high_resolution_clock::now();
+        phase_time_ms_ += std::chrono::duration<double, std::milli>(end - start_).count();
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    double &phase_time_ms_;
+    std::chrono::high_resolution_clock::time_point start_;
+};
 
 
 // An abstract interface for compression algorithms
@@ -11,6 +37,11 @@ public:
     // allocate buffers here if needed
     virtual void Initialize(const ExperimentInput &input) = 0;
     virtual AlgorithType GetAlgorithmType() const = 0;
+    // runtime parameters that tell apart results of the same algorithm type, e.g. "block_size=2048;acceleration=1"
+    [[nodiscard]] virtual std::string GetParameters() const { return ""; }
+    // the scheme an adaptive algorithm chose for the compressed row group, empty for all others. Only valid between
+    // CompressAll and Free
+    [[nodiscard]] virtual std::string GetChosenScheme() const { return ""; }
 
     // Run a full benchmark (compress + decompress + timing)
     AlgorithmResult Benchmark(const ExperimentInput &input) {
@@ -19,16 +50,27 @@ public:
 
         // *** Compression ***
 
+        compression_phase_times_ = {};
+        symbol_table_reuse_ = {};
+
         const auto t0 = clock::now();
         this->CompressAll(input.collector);
+        synopses_.Clear();
+        if (input.build_synopses) {
+            auto timer = TimePhase(CompressionPhase::Synopses);
+            synopses_.Build(input.collector);
+        }
         const auto t1 = clock::now();
-        const auto compression_info = this->CompressedSize();
+        auto compression_info = this->CompressedSize();
+        compression_info.size_synopses = synopses_.SizeInBytes();
+        const auto chosen_scheme = this->GetChosenScheme();
 
         // *** Decompression (ALL) ***
 
         const idx_t decompression_buffer_size = this->GetDecompressionBufferSize(input.collector.TotalBytes());
         auto *decompression_buffer = static_cast<uint8_t *>(malloc(decompression_buffer_size));
 
+        this->ResetDecompressionCaches();
         const auto t2 = clock::now();
         this->DecompressAll(decompression_buffer, decompression_buffer_size);
         const auto t3 = clock::now();
@@ -52,6 +94,8 @@ public:
         const idx_t random_decompression_buffer_size = this->GetDecompressionBufferSize(bytes_to_write);
         auto *random_decompression_buffer = static_cast<uint8_t *>(malloc(random_decompression_buffer_size));
 
+        this->ResetDecompressionCaches();
+        const auto random_cache_before = this->GetBlockCacheCounters();
         const auto t4 = clock::now();
         idx_t total_bytes_written = 0;
         for (const auto row_idx: input.random_row_indices) {
@@ -59,6 +103,7 @@ public:
             total_bytes_written += bytes_written;
         }
         const auto t5 = clock::now();
+        const auto random_cache = this->GetBlockCacheCounters() - random_cache_before;
 
         // check whether the decompressed data matches the original data
         const uint8_t* current_buffer_position = random_decompression_buffer;
@@ -108,6 +153,9 @@ public:
 
         const idx_t vector_decompression_buffer_size = this->GetDecompressionBufferSize(bytes_to_write);
 
+        idx_t n_vector_rows = 0;
+        this->ResetDecompressionCaches();
+        const auto vector_cache_before = this->GetBlockCacheCounters();
         const auto t6 = clock::now();
 
         auto *vector_decompression_buffer = static_cast<uint8_t *>(malloc(vector_decompression_buffer_size));
@@ -129,18 +177,141 @@ public:
             for (idx_t row_idx = start_row; row_idx < end_row; row_idx++) {
                 this->DecompressOne(row_idx, vector_decompression_buffer, vector_decompression_buffer_size);
             }
+            n_vector_rows += VECTOR_SIZE;
         }
         const auto t7 = clock::now();
+        const auto vector_cache = this->GetBlockCacheCounters() - vector_cache_before;
         const auto vector_decompression_hash = duckdb::Hash(vector_decompression_buffer, vector_decompression_buffer_size);
         free(vector_decompression_buffer);
 
+        // *** Decompression (RANDOM ROWS, UNSORTED) ***
+
+        // some of the rows from before, but jumping between blocks like an index lookup would
+        std::vector<idx_t> unsorted_row_indices = input.random_row_indices;
+        std::shuffle(unsorted_row_indices.begin(), unsorted_row_indices.end(), std::mt19937(42));
+        unsorted_row_indices.resize(std::min<size_t>(unsorted_row_indices.size(), N_RANDOM_UNSORTED_ROW_ACCESSES));
+        auto *unsorted_decompression_buffer = static_cast<uint8_t *>(malloc(random_decompression_buffer_size));
+
+        this->ResetDecompressionCaches();
+        const auto unsorted_cache_before = this->GetBlockCacheCounters();
+        const auto t8 = clock::now();
+        total_bytes_written = 0;
+        for (const auto row_idx: unsorted_row_indices) {
+            const idx_t bytes_written = this->DecompressOne(row_idx, unsorted_decompression_buffer + total_bytes_written, random_decompression_buffer_size);
+            total_bytes_written += bytes_written;
+        }
+        const auto t9 = clock::now();
+        const auto unsorted_cache = this->GetBlockCacheCounters() - unsorted_cache_before;
+
+        current_buffer_position = unsorted_decompression_buffer;
+        for (const auto row_idx: unsorted_row_indices) {
+            const auto original_row_size = input.collector.GetLength(row_idx);
+            if (std::memcmp(original_pointers[row_idx], current_buffer_position, original_row_size) != 0) {
+                ErrorHandler::HandleRuntimeError("Unsorted random row decompression data does not match original data at row " + std::to_string(row_idx));
+                break;
+            }
+            current_buffer_position += original_row_size;
+        }
+        free(unsorted_decompression_buffer);
+
+        // *** Decompression (VIEWS) ***
+
+        // the full, random row and random vector decompression again with views, for the algorithms that have them.
+        // Like the copying phases, every phase starts with cold caches. Views of single rows may not outlive the next
+        // call, so they are checked one by one after the timing
+        ViewDecompressionStats views{};
+        const auto check_view = [&](const idx_t row_idx, const std::string_view view) {
+            const auto original_row_size = input.collector.GetLength(row_idx);
+            return view.size() == original_row_size && std::memcmp(view.data(), original_pointers[row_idx], original_row_size) == 0;
+        };
+
+        std::vector<std::string_view> full_views(input.collector.Size());
+        this->ResetDecompressionCaches();
+        const auto t10 = clock::now();
+        views.full = this->DecompressAllViews(full_views.data());
+        const auto t11 = clock::now();
+        if (views.full) {
+            views.time_ms_full = std::chrono::duration<double, std::milli>(t11 - t10).count();
+            for (idx_t row_idx = 0; row_idx < input.collector.Size(); row_idx++) {
+                if (!check_view(row_idx, full_views[row_idx])) {
+                    ErrorHandler::HandleRuntimeError("Full view decompression does not match original data at row " + std::to_string(row_idx));
+                    break;
+                }
+            }
+        }
+
+        std::string_view row_view;
+        views.rows = !input.random_row_indices.empty() && this->DecompressOneView(input.random_row_indices[0], row_view);
+        if (views.rows) {
+            std::vector<std::string_view> random_views(input.random_row_indices.size());
+            this->ResetDecompressionCaches();
+            const auto random_view_cache_before = this->GetBlockCacheCounters();
+            const auto t12 = clock::now();
+            for (size_t i = 0; i < input.random_row_indices.size(); i++) {
+                this->DecompressOneView(input.random_row_indices[i], random_views[i]);
+            }
+            const auto t13 = clock::now();
+            views.block_cache_random = this->GetBlockCacheCounters() - random_view_cache_before;
+            views.time_ms_random = std::chrono::duration<double, std::milli>(t13 - t12).count();
+
+            std::vector<std::string_view> vector_views(VECTOR_SIZE);
+            this->ResetDecompressionCaches();
+            const auto vector_view_cache_before = this->GetBlockCacheCounters();
+            const auto t14 = clock::now();
+            for (const auto vector_idx: input.random_vector_indices) {
+                const idx_t start_row = vector_idx * VECTOR_SIZE;
+                if (start_row + VECTOR_SIZE >= input.collector.Size()) {
+                    continue;
+                }
+                for (idx_t row_idx = start_row; row_idx < start_row + VECTOR_SIZE; row_idx++) {
+                    this->DecompressOneView(row_idx, vector_views[row_idx - start_row]);
+                }
+            }
+            const auto t15 = clock::now();
+            views.block_cache_vector = this->GetBlockCacheCounters() - vector_view_cache_before;
+            views.time_ms_vector = std::chrono::duration<double, std::milli>(t15 - t14).count();
+
+            for (const auto row_idx: input.random_row_indices) {
+                this->DecompressOneView(row_idx, row_view);
+                if (!check_view(row_idx, row_view)) {
+                    ErrorHandler::HandleRuntimeError("Random row view decompression does not match original data at row " + std::to_string(row_idx));
+                    break;
+                }
+            }
+            bool vector_views_match = true;
+            for (const auto vector_idx: input.random_vector_indices) {
+                const idx_t start_row = vector_idx * VECTOR_SIZE;
+                if (start_row + VECTOR_SIZE >= input.collector.Size()) {
+                    continue;
+                }
+                for (idx_t row_idx = start_row; row_idx < start_row + VECTOR_SIZE && vector_views_match; row_idx++) {
+                    this->DecompressOneView(row_idx, row_view);
+                    if (!check_view(row_idx, row_view)) {
+                        ErrorHandler::HandleRuntimeError("Random vector view decompression does not match original data at row " + std::to_string(row_idx));
+                        vector_views_match = false;
+                    }
+                }
+                if (!vector_views_match) {
+                    break;
+                }
+            }
+        }
+
+        // *** Queries ***
+
+        const auto queries = input.run_queries ? this->RunQueries(input) : QueryStats{};
 
         // *** Cleanup ***
         this->Free();
+        synopses_.Clear();
         const auto compression_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
         const auto full_decompression_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count();
         const auto random_decompression_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t5 - t4).count();
         const auto vector_decompression_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t7 - t6).count();
+        const auto unsorted_decompression_duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t9 - t8).count();
+        const auto lookup_latency_ns = [](const double duration_ns, const size_t n_lookups) {
+            return n_lookups == 0 ? 0.0 : duration_ns / static_cast<double>(n_lookups);
+        };
         //
         // printf("Algorithm %s: Compressed size: %llu bytes, compression time: %.3f ms, full decompression time: %.3f ms, vector decompression time: %.3f ms, random decompression time: %.3f ms\n",
         //        ToString(this->GetAlgorithmType()).c_str(),
@@ -162,12 +333,23 @@ public:
             compression_info,
             false, "",
             compression_duration_ns / 1e6,
+            compression_phase_times_,
             full_decompression_duration_ns / 1e6,
             vector_decompression_duration_ns / 1e6,
             random_decompression_duration_ns / 1e6,
+            unsorted_decompression_duration_ns / 1e6,
             full_decompression_hash,
             vector_decompression_hash,
-            random_decompression_hash
+            random_decompression_hash,
+            symbol_table_reuse_,
+            this->GetParameters(),
+            chosen_scheme,
+            {random_cache, lookup_latency_ns(random_decompression_duration_ns, input.random_row_indices.size())},
+            {vector_cache, lookup_latency_ns(vector_decompression_duration_ns, n_vector_rows)},
+            {unsorted_cache, lookup_latency_ns(unsorted_decompression_duration_ns, unsorted_row_indices.size())},
+            {},
+            queries,
+            views
         };
 
 
@@ -175,6 +357,9 @@ public:
 
     // Prepare an internal state by compressing all strings in the collector
     virtual void CompressAll(const StringCollector &data) = 0;
+    // whether the internal state points into the strings CompressAll was given instead of copying them, they then have
+    // to be kept until Free
+    [[nodiscard]] virtual bool ReferencesInput() const { return false; }
 
     virtual idx_t GetDecompressionBufferSize(idx_t decompressed_size) = 0;
     virtual void DecompressAll(uint8_t *out, size_t out_capacity) = 0;
@@ -182,7 +367,251 @@ public:
     // returns the number of bytes written to out
     virtual idx_t DecompressOne(size_t index, uint8_t *out, size_t out_capacity) = 0;
 
+    // Zero-copy decompression: the strings as pointer and length into memory the algorithm keeps them decompressed in,
+    // as a scan would hand them out as duckdb::string_t, instead of copying their bytes. They return false if the
+    // algorithm has no such memory. Views stay valid until Free, those of DecompressOneView only until the next call
+    virtual bool DecompressAllViews(std::string_view *views) { return false; }
+    virtual bool DecompressOneView(size_t index, std::string_view &view) { return false; }
+
     virtual CompressedSizeInfo CompressedSize() = 0;
 
+    // hits and misses of the decompressed block cache so far, for algorithms that have one
+    [[nodiscard]] virtual BlockCacheCounters GetBlockCacheCounters() const { return {}; }
+    // drops what decompression cached so far, e.g. decoded dictionary entries or decompressed blocks, so that every
+    // timed decompression phase starts cold instead of with what the phases before it left behind
+    virtual void ResetDecompressionCaches() {}
+
+    // the phase times and symbol table reuse of CompressAll, for algorithms that run others inside theirs
+    [[nodiscard]] const CompressionPhaseTimes &GetCompressionPhaseTimes() const { return compression_phase_times_; }
+    [[nodiscard]] const SymbolTableReuseInfo &GetSymbolTableReuse() const { return symbol_table_reuse_; }
+
+    // Compressed-domain kernels of the query phases, see StringQueries for what they answer. They return false if the
+    // algorithm has none, the query is then answered on the decompressed strings
+    virtual bool FilterEquals(std::string_view value, std::vector<uint32_t> &rows) { return false; }
+    virtual bool FilterRange(std::string_view low, std::string_view high, std::vector<uint32_t> &rows) { return false; }
+    virtual bool MinMaxPerVector(std::vector<std::string> &mins, std::vector<std::string> &maxes) { return false; }
+    virtual bool SortRows(std::vector<uint32_t> &rows) { return false; }
+    virtual bool GroupCount(std::vector<std::pair<std::string_view, uint64_t>> &groups) { return false; }
+    virtual bool FilterContains(std::string_view needle, std::vector<uint32_t> &rows) { return false; }
+    // the compressed bytes of every row, for algorithms that encode equal strings of the row group to equal bytes. The
+    // hash join phase is keyed on them instead of the strings
+    virtual bool CompressedKeys(std::vector<std::string_view> &keys) { return false; }
+
     virtual void Free() = 0;
+
+protected:
+    // Times a phase of CompressAll(), until the returned timer goes out of scope. Phases can be entered repeatedly,
+    // e.g. when a symbol table is retrained, their times add up
+    [[nodiscard]] PhaseTimer TimePhase(const CompressionPhase phase) {
+        return PhaseTimer(compression_phase_times_[phase]);
+    }
+
+    CompressionPhaseTimes compression_phase_times_{};
+    SymbolTableReuseInfo symbol_table_reuse_{};
+
+private:
+    // Answers the queries with the kernels of the algorithm, or on the decompressed row group if it has none, and
+    // checks the answers against those on the original strings. The filter phase looks for the value of one of the
+    // random rows, the range is between their quartiles, the group by counts the rows of every string, the contains
+    // phase looks for a substring of the filter value. With synopses the filter and range predicates without kernels
+    // decompress only the vectors the synopses do not rule out, and the lookup phase looks for SYNOPSIS_LOOKUPS values
+    // the same way
+    QueryStats RunQueries(const ExperimentInput &input) {
+        using clock = std::chrono::high_resolution_clock;
+        const auto &collector = input.collector;
+        const auto value = StringQueries::ChooseValue(collector, input.random_row_indices);
+        const auto range = StringQueries::ChooseRange(collector, input.random_row_indices);
+        const auto needle = StringQueries::ChooseNeedle(collector, input.random_row_indices);
+        const auto original = StringQueries::Views(collector.Data(), collector);
+
+        // the lengths of the decompressed strings are those of the collector, a decompressed vector has them as well
+        const idx_t buffer_size = this->GetDecompressionBufferSize(collector.TotalBytes());
+        auto *buffer = static_cast<uint8_t *>(malloc(buffer_size));
+        const auto decompress = [&]() {
+            this->DecompressAll(buffer, buffer_size);
+            return StringQueries::Views(buffer, collector);
+        };
+        // the matching rows of the vectors may_match does not rule out, decompressing just their rows. Returns the
+        // number of vectors skipped
+        const auto scan_vectors = [&](const auto &may_match, const auto &matches, std::vector<uint32_t> &rows) {
+            rows.clear();
+            uint64_t n_skipped = 0;
+            for (size_t vector_idx = 0; vector_idx < synopses_.NumVectors(); vector_idx++) {
+                if (!may_match(vector_idx)) {
+                    n_skipped++;
+                    continue;
+                }
+                const size_t end = std::min((vector_idx + 1) * VECTOR_SIZE, collector.Size());
+                for (size_t row = vector_idx * VECTOR_SIZE; row < end; row++) {
+                    const idx_t length = this->DecompressOne(row, buffer, buffer_size);
+                    if (matches(std::string_view(reinterpret_cast<const char *>(buffer), length))) {
+                        rows.push_back(static_cast<uint32_t>(row));
+                    }
+                }
+            }
+            return n_skipped;
+        };
+        const bool skip_vectors = synopses_.NumVectors() > 0;
+        const auto check = [&](const bool matches, const std::string &query) {
+            if (!matches) {
+                ErrorHandler::HandleRuntimeError(query + " query result does not match the original data: Algorithm: " + ToString(this->GetAlgorithmType()));
+            }
+        };
+
+        const auto elapsed_ms = [](const clock::time_point start, const clock::time_point end) {
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        };
+
+        // answers a query with the kernel, or on the decompressed strings if the algorithm has none, returns the time
+        QueryStats stats{};
+        const auto mark_on_codes = [&](const char *query) {
+            stats.on_codes += (stats.on_codes.empty() ? "" : ";") + std::string(query);
+        };
+        const auto answer = [&](const char *query, const auto &kernel, const auto &without_kernel) {
+            const auto start = clock::now();
+            const bool on_codes = kernel();
+            if (!on_codes) {
+                without_kernel();
+            }
+            const auto end = clock::now();
+            if (on_codes) {
+                mark_on_codes(query);
+            }
+            return elapsed_ms(start, end);
+        };
+
+        std::vector<uint32_t> rows;
+        std::vector<uint32_t> expected_rows;
+        stats.n_vectors = synopses_.NumVectors();
+        stats.filter_time_ms = answer("filter", [&] { return this->FilterEquals(value, rows); }, [&] {
+            if (!skip_vectors) {
+                StringQueries::FilterEquals(decompress(), value, rows);
+                return;
+            }
+            stats.filter_vectors_skipped = scan_vectors(
+                [&](const size_t vector_idx) { return synopses_.MayContain(vector_idx, value); },
+                [&](const std::string_view str) { return str == value; }, rows);
+        });
+        StringQueries::FilterEquals(original, value, expected_rows);
+        check(rows == expected_rows, "Filter");
+        stats.filter_rows = rows.size();
+
+        stats.range_time_ms = answer("range", [&] { return this->FilterRange(range.low, range.high, rows); }, [&] {
+            if (!skip_vectors) {
+                StringQueries::FilterRange(decompress(), range, rows);
+                return;
+            }
+            stats.range_vectors_skipped = scan_vectors(
+                [&](const size_t vector_idx) { return synopses_.MayContainRange(vector_idx, range.low, range.high); },
+                [&](const std::string_view str) { return str >= range.low && str <= range.high; }, rows);
+        });
+        StringQueries::FilterRange(original, range, expected_rows);
+        check(rows == expected_rows, "Range");
+        stats.range_rows = rows.size();
+        // the filter and range kernels scan woven codes
+        if (!stats.on_codes.empty()) {
+            stats.scan_kernel = WovenCodes::Kernel();
+        }
+
+        std::vector<std::string> mins, maxes;
+        std::vector<std::string> expected_mins, expected_maxes;
+        stats.min_max_time_ms = answer("min_max", [&] { return this->MinMaxPerVector(mins, maxes); },
+                                       [&] { StringQueries::MinMaxPerVector(decompress(), mins, maxes); });
+        StringQueries::MinMaxPerVector(original, expected_mins, expected_maxes);
+        check(mins == expected_mins && maxes == expected_maxes, "Min/max");
+
+        stats.sort_time_ms = answer("sort", [&] { return this->SortRows(rows); },
+                                    [&] { StringQueries::SortRows(decompress(), rows); });
+        StringQueries::SortRows(original, expected_rows);
+        check(rows == expected_rows, "Sort");
+
+        // the groups are compared in the order of their strings
+        std::vector<std::pair<std::string_view, uint64_t>> groups;
+        std::vector<std::pair<std::string_view, uint64_t>> expected_groups;
+        stats.group_by_time_ms = answer("group_by", [&] { return this->GroupCount(groups); },
+                                        [&] { StringQueries::GroupCount(decompress(), groups); });
+        StringQueries::GroupCount(original, expected_groups);
+        std::sort(groups.begin(), groups.end());
+        std::sort(expected_groups.begin(), expected_groups.end());
+        check(groups == expected_groups, "Group by");
+        stats.group_by_groups = groups.size();
+
+        stats.contains_time_ms = answer("contains", [&] { return this->FilterContains(needle, rows); },
+                                        [&] { StringQueries::FilterContains(decompress(), needle, rows); });
+        StringQueries::FilterContains(original, needle, expected_rows);
+        check(rows == expected_rows, "Contains");
+        stats.contains_rows = rows.size();
+
+        // the self join keyed on the compressed strings, and as the reference keyed on the decompressed strings. The
+        // build and probe times of both cover only the key hashing and comparing. Getting the keys, the compressed
+        // strings or else the decompression, is timed on its own
+        HashJoin join;
+        std::vector<std::string_view> keys;
+        const auto keys_start = clock::now();
+        const bool on_compressed = this->CompressedKeys(keys);
+        if (!on_compressed) {
+            keys = decompress();
+        }
+        const auto build_start = clock::now();
+        join.Build(keys);
+        const auto probe_start = clock::now();
+        stats.hash_join_matches = join.Probe(keys);
+        const auto probe_end = clock::now();
+        stats.hash_join_keys_time_ms = elapsed_ms(keys_start, build_start);
+        stats.hash_join_build_time_ms = elapsed_ms(build_start, probe_start);
+        stats.hash_join_probe_time_ms = elapsed_ms(probe_start, probe_end);
+        stats.hash_join_key_bytes = join.KeyBytes();
+        if (on_compressed) {
+            mark_on_codes("hash_join");
+        }
+        const size_t distinct_keys = join.DistinctKeys();
+
+        HashJoin string_join;
+        keys = decompress();
+        const auto string_build_start = clock::now();
+        string_join.Build(keys);
+        const auto string_probe_start = clock::now();
+        const uint64_t string_matches = string_join.Probe(keys);
+        const auto string_probe_end = clock::now();
+        stats.hash_join_string_build_time_ms = elapsed_ms(string_build_start, string_probe_start);
+        stats.hash_join_string_probe_time_ms = elapsed_ms(string_probe_start, string_probe_end);
+        stats.hash_join_string_key_bytes = string_join.KeyBytes();
+
+        // equal strings with different compressed bytes would show up as additional keys
+        HashJoin expected_join;
+        expected_join.Build(original);
+        check(stats.hash_join_matches == expected_join.Probe(original) && string_matches == stats.hash_join_matches &&
+              distinct_keys == expected_join.DistinctKeys(), "Hash join");
+
+        // the lookups with the synopses, and as the reference on the decompressed row group, as without synopses
+        if (skip_vectors) {
+            const auto lookup_values = StringQueries::ChooseLookupValues(collector, input.random_row_indices, SYNOPSIS_LOOKUPS);
+            std::vector<std::vector<uint32_t>> lookup_rows(lookup_values.size());
+            const auto lookup_start = clock::now();
+            for (size_t i = 0; i < lookup_values.size(); i++) {
+                const std::string_view lookup_value = lookup_values[i];
+                stats.lookup_vectors_skipped += scan_vectors(
+                    [&](const size_t vector_idx) { return synopses_.MayContain(vector_idx, lookup_value); },
+                    [&](const std::string_view str) { return str == lookup_value; }, lookup_rows[i]);
+            }
+            const auto lookup_end = clock::now();
+            for (size_t i = 0; i < lookup_values.size(); i++) {
+                StringQueries::FilterEquals(decompress(), lookup_values[i], rows);
+            }
+            const auto unskipped_lookup_end = clock::now();
+            stats.lookups = lookup_values.size();
+            stats.lookup_time_ms = elapsed_ms(lookup_start, lookup_end);
+            stats.lookup_time_ms_without_synopses = elapsed_ms(lookup_end, unskipped_lookup_end);
+            for (size_t i = 0; i < lookup_values.size(); i++) {
+                StringQueries::FilterEquals(original, lookup_values[i], expected_rows);
+                check(lookup_rows[i] == expected_rows, "Lookup");
+            }
+        }
+        free(buffer);
+
+        return stats;
+    }
+
+    // built by Benchmark after CompressAll if the input asks for them, empty otherwise
+    VectorSynopses synopses_;
 };
\ No newline at end of file
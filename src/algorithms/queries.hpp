@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../models/benchmark_config.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// The queries of the query phases of ICompressionAlgorithm::Benchmark, evaluated on the strings. They answer the
+// queries of algorithms without compressed-domain kernels after decompressing, and are the reference the kernels are
+// checked against
+
+// low <= string <= high, in byte-wise order
+struct RangePredicate {
+    std::string low;
+    std::string high;
+};
+
+class StringQueries {
+public:
+    // the strings of the rows, stored one after the other in data with the lengths of the collector
+    static std::vector<std::string_view> Views(const uint8_t *data, const StringCollector &collector) {
+        std::vector<std::string_view> strings(collector.Size());
+        const auto *str = reinterpret_cast<const char *>(data);
+        for (size_t i = 0; i < collector.Size(); i++) {
+            const size_t length = collector.GetLength(i);
+            strings[i] = std::string_view(str, length);
+            str += length;
+        }
+        return strings;
+    }
+
+    // the string of the middle one of the sampled rows
+    static std::string ChooseValue(const StringCollector &collector, const std::vector<idx_t> &sample_rows) {
+        return sample_rows.empty() ? "" : collector.Get(sample_rows[sample_rows.size() / 2]);
+    }
+
+    // the strings of the first n / 2 sampled rows, and each of them with a byte appended, which most rows do not have
+    static std::vector<std::string> ChooseLookupValues(const StringCollector &collector,
+                                                       const std::vector<idx_t> &sample_rows, const size_t n) {
+        std::vector<std::string> values;
+        for (size_t i = 0; i < std::min(n / 2, sample_rows.size()); i++) {
+            values.push_back(collector.Get(sample_rows[i]));
+            values.push_back(values.back() + '\x01');
+        }
+        return values;
+    }
+
+    // QUERY_NEEDLE_LENGTH bytes from the middle of the string of the middle one of the sampled rows, all of it if it
+    // is shorter
+    static std::string ChooseNeedle(const StringCollector &collector, const std::vector<idx_t> &sample_rows) {
+        const std::string value = ChooseValue(collector, sample_rows);
+        if (value.size() <= QUERY_NEEDLE_LENGTH) {
+            return value;
+        }
+        return value.substr((value.size() - QUERY_NEEDLE_LENGTH) / 2, QUERY_NEEDLE_LENGTH);
+    }
+
+    // the lower and upper quartile of the sampled rows, so about half of the rows match
+    static RangePredicate ChooseRange(const StringCollector &collector, const std::vector<idx_t> &sample_rows) {
+        if (sample_rows.empty()) {
+            return {};
+        }
+        std::vector<std::string_view> sample;
+        sample.reserve(sample_rows.size());
+        const auto pointers = collector.GetPointers();
+        for (const auto row: sample_rows) {
+            sample.emplace_back(reinterpret_cast<const char *>(pointers[row]), pointers[row + 1] - pointers[row]);
+        }
+        std::sort(sample.begin(), sample.end());
+        return {std::string(sample[sample.size() / 4]), std::string(sample[sample.size() * 3 / 4])};
+    }
+
+    // the rows whose string equals value, ascending
+    static void FilterEquals(const std::vector<std::string_view> &strings, const std::string_view value,
+                             std::vector<uint32_t> &rows) {
+        rows.clear();
+        for (size_t i = 0; i < strings.size(); i++) {
+            if (strings[i] == value) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    // the rows whose string satisfies the predicate, ascending
+    static void FilterRange(const std::vector<std::string_view> &strings, const RangePredicate &range,
+                            std::vector<uint32_t> &rows) {
+        rows.clear();
+        for (size_t i = 0; i < strings.size(); i++) {
+            if (strings[i] >= range.low && strings[i] <= range.high) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    // the rows whose string contains needle, ascending
+    static void FilterContains(const std::vector<std::string_view> &strings, const std::string_view needle,
+                               std::vector<uint32_t> &rows) {
+        rows.clear();
+        for (size_t i = 0; i < strings.size(); i++) {
+            if (needle.empty() ||
+                memmem(strings[i].data(), strings[i].size(), needle.data(), needle.size()) != nullptr) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    // the smallest and largest string of every VECTOR_SIZE rows
+    static void MinMaxPerVector(const std::vector<std::string_view> &strings, std::vector<std::string> &mins,
+                                std::vector<std::string> &maxes) {
+        mins.clear();
+        maxes.clear();
+        for (size_t start = 0; start < strings.size(); start += VECTOR_SIZE) {
+            const auto end = strings.begin() + std::min(start + VECTOR_SIZE, strings.size());
+            const auto [min, max] = std::minmax_element(strings.begin() + start, end);
+            mins.emplace_back(*min);
+            maxes.emplace_back(*max);
+        }
+    }
+
+    // the rows in ascending order of their strings, equal strings in row order
+    static void SortRows(const std::vector<std::string_view> &strings, std::vector<uint32_t> &rows) {
+        rows.resize(strings.size());
+        std::iota(rows.begin(), rows.end(), 0);
+        std::stable_sort(rows.begin(), rows.end(), [&strings](const uint32_t a, const uint32_t b) {
+            return strings[a] < strings[b];
+        });
+    }
+
+    // every distinct string with its number of rows, hashing the strings
+    static void GroupCount(const std::vector<std::string_view> &strings,
+                           std::vector<std::pair<std::string_view, uint64_t>> &groups) {
+        robin_hood::unordered_flat_map<std::string_view, uint64_t> counts;
+        for (const auto str: strings) {
+            counts[str]++;
+        }
+        groups.clear();
+        groups.reserve(counts.size());
+        for (const auto &[str, count]: counts) {
+            groups.emplace_back(str, count);
+        }
+    }
+};
+
+// Equi-join of the rows with themselves on their keys: the build side counts the rows of every key, the probe side
+// looks every row up. The keys are the strings, or the compressed strings of an algorithm that encodes equal strings
+// to equal bytes
+class HashJoin {
+public:
+    void Build(const std::vector<std::string_view> &keys) {
+        table_.clear();
+        table_.reserve(keys.size());
+        for (const auto key: keys) {
+            table_[key]++;
+        }
+    }
+
+    // the number of pairs of rows with equal keys
+    [[nodiscard]] uint64_t Probe(const std::vector<std::string_view> &keys) const {
+        uint64_t matches = 0;
+        for (const auto key: keys) {
+            const auto it = table_.find(key);
+            if (it != table_.end()) {
+                matches += it->second;
+            }
+        }
+        return matches;
+    }
+
+    [[nodiscard]] size_t DistinctKeys() const {
+        return table_.size();
+    }
+
+    // the bytes of the distinct keys, what a table that owns its keys stores besides the entries
+    [[nodiscard]] size_t KeyBytes() const {
+        size_t key_bytes = 0;
+        for (const auto &[key, count]: table_) {
+            key_bytes += key.size();
+        }
+        return key_bytes;
+    }
+
+private:
+    robin_hood::unordered_flat_map<std::string_view, uint64_t> table_;
+};
+
+// Building blocks of the query kernels of dictionary encodings
+class CodeQueries {
+public:
+    // the number of rows of every code. For few codes the rows are counted in HISTOGRAM_PARTITIONS histograms that are
+    // summed up at the end, so increments of the same code do not wait for each other
+    static void Histogram(const uint32_t *codes, const size_t n, const size_t n_codes, std::vector<uint64_t> &counts) {
+        counts.assign(n_codes, 0);
+        if (n_codes > HISTOGRAM_MAX_PARTITIONED_CODES) {
+            for (size_t i = 0; i < n; i++) {
+                counts[codes[i]]++;
+            }
+            return;
+        }
+        std::vector<uint32_t> partitions(HISTOGRAM_PARTITIONS * n_codes, 0);
+        size_t i = 0;
+        for (; i + HISTOGRAM_PARTITIONS <= n; i += HISTOGRAM_PARTITIONS) {
+            for (size_t partition = 0; partition < HISTOGRAM_PARTITIONS; partition++) {
+                partitions[partition * n_codes + codes[i + partition]]++;
+            }
+        }
+        for (; i < n; i++) {
+            partitions[codes[i]]++;
+        }
+        for (size_t partition = 0; partition < HISTOGRAM_PARTITIONS; partition++) {
+            for (size_t code = 0; code < n_codes; code++) {
+                counts[code] += partitions[partition * n_codes + code];
+            }
+        }
+    }
+
+private:
+    static constexpr size_t HISTOGRAM_PARTITIONS = 4;
+    static constexpr size_t HISTOGRAM_MAX_PARTITIONED_CODES = 16384;
+};
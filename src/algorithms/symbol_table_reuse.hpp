@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../models/benchmark_config.hpp"
+
+// Bookkeeping for algorithms that compress the row groups of a column with a symbol table trained on an earlier one
+namespace SymbolTableReuse {
+
+// Returns the table the row group should be compressed with, or nullptr if it has to train its own one
+inline const TrainedSymbolTable *Find(const ColumnContext *context, const AlgorithType algorithm,
+                                      const size_t row_group_idx) {
+    if (context == nullptr) return nullptr;
+    const auto it = context->trained_symbol_tables.find(algorithm);
+    if (it == context->trained_symbol_tables.end()) return nullptr;
+
+    // only tables of earlier row groups count, a table trained on this row group came from a previous run on it
+    for (auto table = it->second.rbegin(); table != it->second.rend(); ++table) {
+        if (table->trained_row_group_idx < row_group_idx) return &*table;
+    }
+    return nullptr;
+}
+
+// Keeps a table trained on the row group, replacing one trained by an earlier run on the same row group
+inline void Store(ColumnContext *context, const AlgorithType algorithm, const size_t row_group_idx,
+                  std::shared_ptr<void> table, const double compression_ratio) {
+    if (context == nullptr) return;
+    auto &tables = context->trained_symbol_tables[algorithm];
+
+    std::vector<TrainedSymbolTable> kept;
+    if (const TrainedSymbolTable *previous = Find(context, algorithm, row_group_idx)) {
+        kept.push_back(*previous);
+    }
+    kept.push_back({std::move(table), row_group_idx, compression_ratio});
+    tables = std::move(kept);
+}
+
+inline bool NeedsRetraining(const TrainedSymbolTable &trained, const double escape_rate, const double compression_ratio) {
+    return escape_rate > REUSE_MAX_ESCAPE_RATE ||
+           compression_ratio < trained.trained_compression_ratio * (1.0 - REUSE_MAX_RATIO_DEGRADATION);
+}
+
+} // namespace SymbolTableReuse
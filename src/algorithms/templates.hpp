@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../models/benchmark_config.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Building blocks of TemplateAlgorithm: strings are split into words at delimiters, templates of words with variable
+// slots are mined from a sample, and every string is matched against them
+
+// A template: the literal text around its slots, literals[i] comes before slot i and the last literal after the last
+// slot. A string of the template is literals[0] + slot 0 + literals[1] + ... + literals[n_slots]
+struct LogTemplate {
+    std::vector<std::string> literals;
+    // the skeleton of the strings of the template (see TemplateUtils::Tokenize), only used while compressing to find
+    // the templates a string can be of
+    std::string skeleton;
+
+    [[nodiscard]] size_t NSlots() const {
+        return literals.size() - 1;
+    }
+
+    // the template with a slot shown as {}, e.g. GET /api/v1/user/{} HTTP/1.1
+    [[nodiscard]] std::string ToString() const {
+        std::string text = literals[0];
+        for (size_t slot = 1; slot < literals.size(); slot++) {
+            text += "{}" + literals[slot];
+        }
+        return text;
+    }
+};
+
+class TemplateUtils {
+public:
+    // marks a word in the skeleton of a string, it is no delimiter so a skeleton is unambiguous
+    static constexpr char WORD_MARKER = '\x01';
+
+    // the bytes that separate the words of a string: white space, punctuation of paths, URLs, key-value pairs and
+    // numbers. A slot is always a whole word, so numbers with a '.' or '-' are split into one slot per part
+    static bool IsDelimiter(const uint8_t c) {
+        static constexpr auto table = [] {
+            std::array<bool, 256> delimiters{};
+            for (const char c: std::string_view(" \t\r\n/\\:=,;?&\"'()[]{}<>|@#.-+*%!$~^`")) {
+                delimiters[static_cast<uint8_t>(c)] = true;
+            }
+            return delimiters;
+        }();
+        return table[c];
+    }
+
+    // the string with every word replaced by WORD_MARKER, the start and end of the words are appended to words
+    static void Tokenize(const uint8_t *str, const size_t len, std::string &skeleton,
+                         std::vector<std::pair<uint32_t, uint32_t>> &words) {
+        skeleton.clear();
+        words.clear();
+        size_t pos = 0;
+        while (pos < len) {
+            if (IsDelimiter(str[pos])) {
+                skeleton.push_back(static_cast<char>(str[pos++]));
+                continue;
+            }
+            const size_t start = pos;
+            while (pos < len && !IsDelimiter(str[pos])) {
+                pos++;
+            }
+            skeleton.push_back(WORD_MARKER);
+            words.emplace_back(start, pos);
+        }
+    }
+
+    // Drain-style mining: strings with the same skeleton are clustered, a string joins the first cluster of its
+    // skeleton that agrees on at least TEMPLATE_SIMILARITY of the words, the words the cluster disagrees on become
+    // slots. Words with a digit always agree, like slots, but stay literal while they are the same in every string,
+    // e.g. the version of HTTP/1.1. The TEMPLATE_MAX_TEMPLATES clusters with the most strings that were seen at least
+    // twice become the templates
+    static std::vector<LogTemplate> Mine(const std::vector<std::string_view> &sample) {
+        struct Cluster {
+            std::string skeleton;
+            std::vector<std::string> words;
+            std::vector<bool> is_slot;
+            std::vector<bool> has_digit;
+            size_t support;
+        };
+        std::vector<Cluster> clusters;
+        robin_hood::unordered_flat_map<std::string, std::vector<uint32_t>> clusters_by_skeleton;
+
+        std::string skeleton;
+        std::vector<std::pair<uint32_t, uint32_t>> words;
+        for (const auto str: sample) {
+            const auto *bytes = reinterpret_cast<const uint8_t *>(str.data());
+            Tokenize(bytes, str.size(), skeleton, words);
+
+            auto &candidates = clusters_by_skeleton[skeleton];
+            bool clustered = false;
+            for (const uint32_t cluster_idx: candidates) {
+                auto &cluster = clusters[cluster_idx];
+                size_t n_agreeing = 0;
+                for (size_t w = 0; w < words.size(); w++) {
+                    n_agreeing += cluster.is_slot[w] || cluster.has_digit[w] || cluster.words[w] == WordOf(str, words[w]);
+                }
+                if (static_cast<double>(n_agreeing) < TEMPLATE_SIMILARITY * static_cast<double>(words.size())) {
+                    continue;
+                }
+                for (size_t w = 0; w < words.size(); w++) {
+                    if (!cluster.is_slot[w] && cluster.words[w] != WordOf(str, words[w])) {
+                        cluster.is_slot[w] = true;
+                    }
+                }
+                cluster.support++;
+                clustered = true;
+                break;
+            }
+            if (clustered || candidates.size() >= TEMPLATE_MAX_CLUSTERS_PER_SKELETON) {
+                continue;
+            }
+
+            Cluster cluster{skeleton, {}, {}, {}, 1};
+            for (const auto &word: words) {
+                const auto text = WordOf(str, word);
+                cluster.words.emplace_back(text);
+                cluster.is_slot.push_back(false);
+                cluster.has_digit.push_back(std::any_of(text.begin(), text.end(), [](const char c) {
+                    return c >= '0' && c <= '9';
+                }));
+            }
+            candidates.push_back(static_cast<uint32_t>(clusters.size()));
+            clusters.push_back(std::move(cluster));
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) {
+            return a.support > b.support;
+        });
+        std::vector<LogTemplate> templates;
+        for (const auto &cluster: clusters) {
+            if (templates.size() == TEMPLATE_MAX_TEMPLATES || cluster.support < 2) {
+                break;
+            }
+            LogTemplate log_template{{""}, cluster.skeleton};
+            size_t w = 0;
+            for (const char c: cluster.skeleton) {
+                if (c != WORD_MARKER) {
+                    log_template.literals.back().push_back(c);
+                } else if (cluster.is_slot[w++]) {
+                    log_template.literals.emplace_back();
+                } else {
+                    log_template.literals.back() += cluster.words[w - 1];
+                }
+            }
+            templates.push_back(std::move(log_template));
+        }
+        return templates;
+    }
+
+    // whether the string is of the template, the start and end of its slots are written to slots. A slot is the word
+    // following its literal, which always starts with a delimiter as words are separated by them
+    static bool Match(const LogTemplate &log_template, const uint8_t *str, const size_t len,
+                      std::pair<uint32_t, uint32_t> *slots) {
+        size_t pos = 0;
+        for (size_t slot = 0; slot < log_template.NSlots(); slot++) {
+            const auto &literal = log_template.literals[slot];
+            if (len - pos < literal.size() || std::memcmp(str + pos, literal.data(), literal.size()) != 0) {
+                return false;
+            }
+            pos += literal.size();
+            const size_t start = pos;
+            while (pos < len && !IsDelimiter(str[pos])) {
+                pos++;
+            }
+            slots[slot] = {static_cast<uint32_t>(start), static_cast<uint32_t>(pos)};
+        }
+        const auto &last = log_template.literals.back();
+        return len - pos == last.size() && std::memcmp(str + pos, last.data(), last.size()) == 0;
+    }
+
+private:
+    static std::string_view WordOf(const std::string_view str, const std::pair<uint32_t, uint32_t> &word) {
+        return str.substr(word.first, word.second - word.first);
+    }
+};
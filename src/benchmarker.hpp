@@ -6,6 +6,7 @@
 #include "models/compression_result.hpp"
 #include "models/string_collection.hpp"
 #include "models/benchmark_config.hpp"
+#include "utils/column_profiler.hpp"
 
 
 inline void replace_all(std::string &str, const std::string &from, const std::string &to) {
@@ -22,7 +23,8 @@ inline ExperimentResult RunExperimentForColumn(
     const BenchmarkConfig &config,
     const TableConfig &table_config,
     const std::string &column_name,
-    const ExperimentState &state
+    const ExperimentState &state,
+    ColumnContext &column_context
 ) {
     StringCollector collector(ROW_GROUP_SIZE_NUMBER_OF_BYTES, ROW_GROUP_SIZE_NUMBER_OF_VALUES);
 
@@ -140,14 +142,34 @@ inline ExperimentResult RunExperimentForColumn(
                             query_result->RowCount(), collector.Size(),
                             table_config.name, column_name
     );
+    result.SetProfile(ProfileColumn(collector));
 
     const auto random_row_indices = GenerateRandomIndices(N_RANDOM_ROW_ACCESSES, collector.Size() - 1);
     const auto random_vector_indices = GenerateRandomIndices(N_RANDOM_VECTOR_ACCESSES, (collector.Size() / VECTOR_SIZE) - 1);
 
-    const ExperimentInput input{const_cast<StringCollector &>(collector), random_row_indices, random_vector_indices};
+    const ExperimentInput input{
+        const_cast<StringCollector &>(collector), random_row_indices, random_vector_indices,
+        state.row_group_idx, &column_context, config.algorithms, config.selection_goals, config.run_queries,
+        config.build_synopses
+    };
 
+    std::vector<AlgorithmResult> algorithm_results;
     for (const AlgorithType algo: config.algorithms) {
-        result.AddResult(Compress(algo, input, config.n_repeats));
+        for (const auto &algorithm_result: CompressSweep(algo, input, config.n_repeats, config.block_codec_parameters)) {
+            algorithm_results.push_back(algorithm_result);
+        }
+    }
+    // after all others, so AutoSelect is rated against the algorithms it chooses among
+    if (config.strip_affixes) {
+        for (const AlgorithType algo: config.algorithms) {
+            for (const auto &algorithm_result: CompressSweep(algo, input, config.n_repeats, config.block_codec_parameters, true)) {
+                algorithm_results.push_back(algorithm_result);
+            }
+        }
+    }
+    EvaluateAutoSelect(algorithm_results, collector.TotalSizeRequired(), config.selection_goals);
+    for (const auto &algorithm_result: algorithm_results) {
+        result.AddResult(algorithm_result);
     }
 
     return result;
@@ -167,9 +189,10 @@ inline std::vector<ExperimentResult> RunExperiment(duckdb::Connection &con, cons
                file.name.c_str());
         for (const auto &column: file.columns) {
             auto state = ExperimentState::Init();
+            ColumnContext column_context;
             idx_t row_group_idx = 0;
             while (row_group_idx < config.n_row_groups) {
-                auto res = RunExperimentForColumn(con, config, file, column, state);
+                auto res = RunExperimentForColumn(con, config, file, column, state, column_context);
                 results.push_back(res);
                 if (res.GetNumRows() == 0) {
                     break;
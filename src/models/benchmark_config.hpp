@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
 
 #include "compression_result.hpp"
 #include "string_collection.hpp"
@@ -14,6 +16,76 @@ constexpr idx_t MIN_NON_EMPTY_ROWS = ROW_GROUP_SIZE_NUMBER_OF_VALUES / 4;
 
 constexpr idx_t N_RANDOM_ROW_ACCESSES = MIN_NON_EMPTY_ROWS;
 constexpr idx_t N_RANDOM_VECTOR_ACCESSES = MIN_NON_EMPTY_ROWS / VECTOR_SIZE;
+// unsorted random rows miss a small block cache nearly every time, so fewer of them are looked up
+constexpr idx_t N_RANDOM_UNSORTED_ROW_ACCESSES = N_RANDOM_ROW_ACCESSES / 8;
+
+// a reused symbol table is retrained once it escapes more codes or compresses that much worse than on its own row group
+constexpr double REUSE_MAX_ESCAPE_RATE = 0.1;
+constexpr double REUSE_MAX_RATIO_DEGRADATION = 0.1;
+
+// zstd level and the size of trained dictionaries. Training time grows with the sample, a quarter of a row group is
+// plenty for a dictionary this small
+constexpr int ZSTD_COMPRESSION_LEVEL = 3;
+constexpr size_t ZSTD_DICTIONARY_CAPACITY = 16 * 1024;
+constexpr size_t ZSTD_DICTIONARY_SAMPLE_SIZE = 16 * ZSTD_DICTIONARY_CAPACITY;
+
+// size of the dictionary LZ4 compresses every block with, its window can reach back 64 KB
+constexpr size_t LZ4_DICTIONARY_CAPACITY = 16 * 1024;
+
+// strings between two front coding restart points, which store their string in full
+constexpr size_t FRONT_CODING_RESTART_INTERVAL = 16;
+
+// entropy coded variants: longest Huffman code, number of symbols with a code of their own (including the escape) and
+// rows per block that starts at a known bit offset. Full decompression decodes that many blocks at the same time
+constexpr uint8_t HUFFMAN_MAX_CODE_LENGTH = 12;
+constexpr size_t HUFFMAN_MAX_SYMBOLS = 1024;
+constexpr size_t ENTROPY_BLOCK_SIZE = 32;
+constexpr size_t ENTROPY_INTERLEAVED_STREAMS = 4;
+
+// cascading compression: levels of schemes, e.g. dictionary codes that are run-length encoded and their runs bitpacked
+// are three. Every level picks the scheme that compresses CASCADE_SAMPLE_RUNS runs of CASCADE_SAMPLE_RUN_LENGTH
+// consecutive values best (about 1% of a row group). Raw and FSST strings keep the offset of every
+// CASCADE_OFFSET_SAMPLE-th string for random access
+constexpr size_t CASCADE_MAX_DEPTH = 3;
+constexpr size_t CASCADE_SAMPLE_RUNS = 16;
+constexpr size_t CASCADE_SAMPLE_RUN_LENGTH = 64;
+constexpr size_t CASCADE_OFFSET_SAMPLE = 64;
+
+// TypedString stores the strings as binary values if at least this share of them is in one format
+constexpr double TYPED_STRING_MIN_MATCH_FRACTION = 0.5;
+
+// Template mines at most TEMPLATE_MAX_TEMPLATES templates from TEMPLATE_SAMPLE_RUNS runs of TEMPLATE_SAMPLE_RUN_LENGTH
+// consecutive strings. A string joins a template if at least TEMPLATE_SIMILARITY of its words agree, strings of one
+// skeleton form at most TEMPLATE_MAX_CLUSTERS_PER_SKELETON templates. The number of strings of every template before
+// every TEMPLATE_RANK_SAMPLE-th string is kept for random access
+constexpr size_t TEMPLATE_MAX_TEMPLATES = 64;
+constexpr size_t TEMPLATE_SAMPLE_RUNS = 32;
+constexpr size_t TEMPLATE_SAMPLE_RUN_LENGTH = 64;
+constexpr double TEMPLATE_SIMILARITY = 0.5;
+constexpr size_t TEMPLATE_MAX_CLUSTERS_PER_SKELETON = 16;
+constexpr size_t TEMPLATE_RANK_SAMPLE = 128;
+
+// OrderedDictionary sorts its unique strings on a thread per ORDERED_DICTIONARY_MIN_SORT_CHUNK of them, smaller
+// dictionaries are sorted on one thread
+constexpr size_t ORDERED_DICTIONARY_MIN_SORT_CHUNK = 16384;
+
+// bits of the bloom filter of a vector synopsis per distinct string of the vector, and the number of equality lookups
+// of the lookup phase (half of them values no row has)
+constexpr size_t SYNOPSIS_BLOOM_BITS_PER_KEY = 10;
+constexpr size_t SYNOPSIS_LOOKUPS = 32;
+
+// FMIndex samples the suffix array at every FM_INDEX_SA_SAMPLE_RATE-th text position, a located occurrence takes at
+// most that many LF steps. The substring query of the contains phase is QUERY_NEEDLE_LENGTH bytes long
+constexpr size_t FM_INDEX_SA_SAMPLE_RATE = 32;
+constexpr size_t QUERY_NEEDLE_LENGTH = 8;
+
+// AutoSelect compresses AUTO_SELECT_SAMPLE_RUNS runs of AUTO_SELECT_SAMPLE_RUN_LENGTH consecutive strings (2.5% of a
+// row group) with every candidate and looks up at most AUTO_SELECT_SAMPLE_LOOKUPS of them one by one. Both are timed
+// AUTO_SELECT_TIMED_RUNS times after a warm-up run, the fastest run counts
+constexpr size_t AUTO_SELECT_SAMPLE_RUNS = 24;
+constexpr size_t AUTO_SELECT_SAMPLE_RUN_LENGTH = 128;
+constexpr size_t AUTO_SELECT_SAMPLE_LOOKUPS = 256;
+constexpr size_t AUTO_SELECT_TIMED_RUNS = 3;
 
 struct ExperimentState {
     size_t row_group_idx;
@@ -25,6 +97,26 @@ struct ExperimentState {
 };
 
 
+// A symbol table trained on one row group, kept to compress the following row groups of the same column
+struct TrainedSymbolTable {
+    // algorithm specific table (e.g. an fsst_encoder_t), freed by the deleter of the shared pointer
+    std::shared_ptr<void> table;
+    size_t trained_row_group_idx;
+    // compression ratio of the string data on the row group the table was trained on
+    double trained_compression_ratio;
+};
+
+// State that lives across all row groups of a column
+struct ColumnContext {
+    // per algorithm the table of the latest row group that trained one, preceded by the table that was current before
+    // (repeated runs on the latest row group must see the same table as the first run did)
+    std::unordered_map<AlgorithType, std::vector<TrainedSymbolTable>> trained_symbol_tables;
+    // the state of the algorithms that compress the column with the common prefix and suffix stripped, their tables
+    // are trained on other strings
+    std::unique_ptr<ColumnContext> affix_stripped;
+};
+
+
 struct TableConfig {
     std::string name;
     std::vector<std::string> columns;
@@ -35,6 +127,109 @@ enum RowGroupMode {
     FIXED_NUMBER_OF_BYTES
 };
 
+// Which decompressed block the block cache of the block codecs evicts when it is full
+enum class BlockCachePolicy {
+    LRU, // the least recently used one
+    Clock, // the next one the clock hand finds not referenced since it last passed
+};
+
+inline std::string ToString(const BlockCachePolicy policy) {
+    switch (policy) {
+        case BlockCachePolicy::LRU: return "lru";
+        case BlockCachePolicy::Clock: return "clock";
+    }
+    return "unknown";
+}
+
+// Runtime parameters of the block codecs (LZ4, LZ4Dict, Zstd), each codec ignores the ones it does not have
+struct BlockCodecParameters {
+    // strings per block
+    size_t block_size = VECTOR_SIZE;
+    // if not 0, blocks are cut after the first string that brings them to this many bytes instead
+    size_t block_bytes = 0;
+    // LZ4 acceleration, 1 is LZ4_compress_default
+    int acceleration = 1;
+    // LZ4HC compression level, 0 compresses with plain LZ4
+    int hc_level = 0;
+    // zstd compression level
+    int zstd_level = ZSTD_COMPRESSION_LEVEL;
+    // decompressed blocks kept for random access, at most cache_bytes of them if that is not 0
+    BlockCachePolicy cache_policy = BlockCachePolicy::LRU;
+    size_t cache_blocks = 1;
+    size_t cache_bytes = 0;
+
+    bool operator==(const BlockCodecParameters &other) const = default;
+};
+
+// Block sizes from 256 to 65536 strings and byte targets, then accelerations, LZ4HC levels, zstd levels and block
+// caches at the default block size. The LZ4 rows apply to LZ4Dict as well, and LZ4HC also runs on the small blocks
+// where a dictionary helps most
+inline std::vector<BlockCodecParameters> BlockCodecSweep() {
+    std::vector<BlockCodecParameters> sweep;
+    for (size_t block_size = 256; block_size <= 65536; block_size *= 2) {
+        sweep.push_back({block_size, 0, 1, 0});
+    }
+    for (const size_t block_bytes: {4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024}) {
+        sweep.push_back({VECTOR_SIZE, block_bytes, 1, 0});
+    }
+    for (const int acceleration: {2, 4, 8, 16, 64}) {
+        sweep.push_back({VECTOR_SIZE, 0, acceleration, 0});
+    }
+    for (const int hc_level: {3, 6, 9, 12}) {
+        sweep.push_back({VECTOR_SIZE, 0, 1, hc_level});
+    }
+    for (const size_t block_size: {256, 512}) {
+        sweep.push_back({block_size, 0, 1, 9});
+    }
+    for (const int zstd_level: {1, 6, 9, 19}) {
+        sweep.push_back({VECTOR_SIZE, 0, 1, 0, zstd_level});
+    }
+    for (const BlockCachePolicy cache_policy: {BlockCachePolicy::LRU, BlockCachePolicy::Clock}) {
+        for (const size_t cache_blocks: {4, 16, 64}) {
+            sweep.push_back({VECTOR_SIZE, 0, 1, 0, ZSTD_COMPRESSION_LEVEL, cache_policy, cache_blocks, 0});
+        }
+        // a memory budget of a quarter of the row group
+        sweep.push_back({
+            VECTOR_SIZE, 0, 1, 0, ZSTD_COMPRESSION_LEVEL, cache_policy, 64, ROW_GROUP_SIZE_NUMBER_OF_BYTES / 4
+        });
+    }
+    return sweep;
+}
+
+// The algorithms the benchmark runs unless others are asked for, AutoSelect chooses among them
+inline std::vector<AlgorithType> DefaultAlgorithms() {
+    return {
+        AlgorithType::FSST,
+        AlgorithType::FSST12,
+        AlgorithType::OnPair16,
+        AlgorithType::Dictionary,
+        AlgorithType::LZ4,
+        AlgorithType::FSSTParallel,
+        AlgorithType::FSSTReuse,
+        AlgorithType::FSST12Reuse,
+        AlgorithType::DictionaryFSST,
+        AlgorithType::Zstd,
+        AlgorithType::ZstdRowGroupDict,
+        AlgorithType::ZstdColumnDict,
+        AlgorithType::LZ4Dict,
+        AlgorithType::FrontCoding,
+        AlgorithType::FrontCodingFSST,
+        AlgorithType::RLEDictionary,
+        AlgorithType::DictionaryHuffman,
+        AlgorithType::FSSTHuffman,
+        AlgorithType::Cascade,
+        AlgorithType::TypedString,
+        AlgorithType::Template,
+    };
+}
+
+// What AutoSelect chooses for: the weight of each goal in its cost model, a goal with weight 0 is ignored
+struct SelectionGoals {
+    double compression_ratio = 1.0;
+    double decompression_speed = 1.0;
+    double random_access = 0.0;
+};
+
 struct BenchmarkConfigMetaData {
     uint64_t n_repeats;
     uint64_t n_row_groups;
@@ -42,6 +237,15 @@ struct BenchmarkConfigMetaData {
     bool cut_by_min_bytes;
     std::vector<AlgorithType> algorithms;
     RowGroupMode row_group_mode;
+    // the block codecs emit one result per parameter set
+    std::vector<BlockCodecParameters> block_codec_parameters = {BlockCodecParameters{}};
+    SelectionGoals selection_goals = {};
+    // also run every algorithm on the strings with the prefix and suffix all strings of the row group share stripped
+    bool strip_affixes = false;
+    // run the query phases after decompressing, see ICompressionAlgorithm::RunQueries
+    bool run_queries = false;
+    // build per-vector synopses while compressing, the predicate query phases skip the vectors they rule out
+    bool build_synopses = false;
 };
 
 
@@ -55,4 +259,12 @@ struct ExperimentInput {
     StringCollector &collector;
     std::vector<idx_t> random_row_indices;
     std::vector<idx_t> random_vector_indices;
+    size_t row_group_idx = 0;
+    // null if the experiment does not belong to a column, e.g. when compressing a sample
+    ColumnContext *column_context = nullptr;
+    // the algorithms AutoSelect chooses among (it skips itself) and what it chooses for
+    std::vector<AlgorithType> auto_select_candidates = {};
+    SelectionGoals selection_goals = {};
+    bool run_queries = false;
+    bool build_synopses = false;
 };
\ No newline at end of file
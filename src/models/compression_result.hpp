@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <fstream>
 #include <utility>
 #include <vector>
@@ -22,6 +23,25 @@ enum class AlgorithType {
     OnPairMini14,
     Dictionary,
     LZ4,
+    FSSTParallel,
+    FSSTReuse,
+    FSST12Reuse,
+    DictionaryFSST,
+    Zstd,
+    ZstdRowGroupDict,
+    ZstdColumnDict,
+    LZ4Dict,
+    FrontCoding,
+    FrontCodingFSST,
+    RLEDictionary,
+    DictionaryHuffman,
+    FSSTHuffman,
+    Cascade,
+    AutoSelect,
+    TypedString,
+    Template,
+    OrderedDictionary,
+    FMIndex,
 };
 
 
@@ -36,10 +56,40 @@ inline std::string ToString(AlgorithType algo) {
         case AlgorithType::OnPairMini14: return "OnPairMini14";
         case AlgorithType::Dictionary: return "Dictionary";
         case AlgorithType::LZ4: return "LZ4";
+        case AlgorithType::FSSTParallel: return "FSSTParallel";
+        case AlgorithType::FSSTReuse: return "FSSTReuse";
+        case AlgorithType::FSST12Reuse: return "FSST12Reuse";
+        case AlgorithType::DictionaryFSST: return "DictionaryFSST";
+        case AlgorithType::Zstd: return "Zstd";
+        case AlgorithType::ZstdRowGroupDict: return "ZstdRowGroupDict";
+        case AlgorithType::ZstdColumnDict: return "ZstdColumnDict";
+        case AlgorithType::LZ4Dict: return "LZ4Dict";
+        case AlgorithType::FrontCoding: return "FrontCoding";
+        case AlgorithType::FrontCodingFSST: return "FrontCodingFSST";
+        case AlgorithType::RLEDictionary: return "RLEDictionary";
+        case AlgorithType::DictionaryHuffman: return "DictionaryHuffman";
+        case AlgorithType::FSSTHuffman: return "FSSTHuffman";
+        case AlgorithType::Cascade: return "Cascade";
+        case AlgorithType::AutoSelect: return "AutoSelect";
+        case AlgorithType::TypedString: return "TypedString";
+        case AlgorithType::Template: return "Template";
+        case AlgorithType::OrderedDictionary: return "OrderedDictionary";
+        case AlgorithType::FMIndex: return "FMIndex";
     }
     return "Unknown";
 }
 
+// the algorithm ToString names name, false if none does
+inline bool AlgorithTypeFromString(const std::string &name, AlgorithType &algo) {
+    for (int i = 0; i <= static_cast<int>(AlgorithType::FMIndex); i++) {
+        if (ToString(static_cast<AlgorithType>(i)) == name) {
+            algo = static_cast<AlgorithType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
 
 struct CompressedSizeParts {
     // the data that the raw strings in the dictionary need can be complete strings for DICTIONARY COMPRESSION or substrings for FSST
@@ -67,6 +117,10 @@ struct CompressedSizeParts {
 struct CompressedSizeInfo {
     uint64_t compressed_size;
     CompressedSizeParts parts;
+    // the part of compressed_size that does not grow with the number of rows, trained symbol tables and dictionaries
+    uint64_t size_fixed = 0;
+    // the per-vector synopses, if built. Not part of compressed_size, so ratios compare with and without them
+    uint64_t size_synopses = 0;
 
     static CompressedSizeInfo FSST(uint64_t symbol_table_size, uint64_t data_codes_size, uint64_t data_lengths_size) {
         return CompressedSizeInfo{
@@ -78,7 +132,8 @@ struct CompressedSizeInfo {
                 data_codes_size, // size_data_codes
                 data_lengths_size, // size_data_lengths
                 data_codes_size + data_lengths_size // size_data
-            }
+            },
+            symbol_table_size // size_fixed
         };
     }
 
@@ -115,6 +170,42 @@ struct CompressedSizeInfo {
         };
     }
 
+    static CompressedSizeInfo RunLengthDictionary(uint64_t dictionary_strings_size, uint64_t dictionary_lengths_size,
+                                                  uint64_t run_values_size, uint64_t run_ends_size) {
+        // one code per run instead of per row, the row each run ends at takes the place of the lengths
+        const uint64_t dictionary_size = dictionary_strings_size + dictionary_lengths_size;
+        return CompressedSizeInfo{
+            dictionary_size + run_values_size + run_ends_size,
+            {
+                dictionary_strings_size, // size_dictionary_strings
+                dictionary_lengths_size, // size_dictionary_lengths
+                dictionary_size, // size_dictionary
+                run_values_size, // size_data_codes
+                run_ends_size, // size_data_lengths
+                run_values_size + run_ends_size // size_data
+            }
+        };
+    }
+
+    static CompressedSizeInfo DictionaryFSST(uint64_t symbol_table_size, uint64_t dictionary_strings_size,
+                                             uint64_t dictionary_lengths_size, uint64_t data_codes_size) {
+        // the symbol table only encodes the dictionary, so it is part of it
+        const uint64_t dictionary_size = symbol_table_size + dictionary_strings_size + dictionary_lengths_size;
+        constexpr uint64_t data_lengths_size = 0;
+        return CompressedSizeInfo{
+            dictionary_size + data_codes_size,
+            {
+                symbol_table_size + dictionary_strings_size, // size_dictionary_strings
+                dictionary_lengths_size, // size_dictionary_lengths
+                dictionary_size, // size_dictionary
+                data_codes_size, // size_data_codes
+                data_lengths_size, // size_data_lengths
+                data_codes_size + data_lengths_size // size_data
+            },
+            symbol_table_size // size_fixed
+        };
+    }
+
     static CompressedSizeInfo LZ4(uint64_t data_codes_size, uint64_t data_lengths_size) {
         // the dictionary will be built from the data itself, so we do not count it here
         constexpr uint64_t dictionary_strings_size = 0;
@@ -133,8 +224,276 @@ struct CompressedSizeInfo {
             }
         };
     }
+
+    static CompressedSizeInfo BlockWithDictionary(uint64_t dictionary_size, uint64_t data_codes_size,
+                                                  uint64_t data_lengths_size) {
+        // a dictionary trained on the data, the blocks are compressed independently of each other
+        constexpr uint64_t dictionary_lengths_size = 0;
+
+        return CompressedSizeInfo{
+            dictionary_size + data_codes_size + data_lengths_size,
+            {
+                dictionary_size, // size_dictionary_strings
+                dictionary_lengths_size, // size_dictionary_lengths
+                dictionary_size, // size_dictionary
+                data_codes_size, // size_data_codes
+                data_lengths_size, // size_data_lengths
+                data_codes_size + data_lengths_size // size_data
+            },
+            dictionary_size // size_fixed
+        };
+    }
+
+    static CompressedSizeInfo Cascade(uint64_t symbol_tables_size, uint64_t dictionary_size, uint64_t data_codes_size,
+                                      uint64_t data_lengths_size) {
+        // the symbol tables of all FSST levels are part of the dictionary, the distinct strings too if the column is
+        // dictionary encoded
+        constexpr uint64_t dictionary_lengths_size = 0;
+        return CompressedSizeInfo{
+            dictionary_size + data_codes_size + data_lengths_size,
+            {
+                dictionary_size, // size_dictionary_strings
+                dictionary_lengths_size, // size_dictionary_lengths
+                dictionary_size, // size_dictionary
+                data_codes_size, // size_data_codes
+                data_lengths_size, // size_data_lengths
+                data_codes_size + data_lengths_size // size_data
+            },
+            symbol_tables_size // size_fixed
+        };
+    }
+
+    static CompressedSizeInfo TypedString(uint64_t symbol_table_size, uint64_t values_size, uint64_t exceptions_size,
+                                          uint64_t exception_index_size) {
+        // the binary values and the FSST-compressed strings that do not parse are the codes, the rows and lengths of
+        // those exceptions the lengths. The symbol table only encodes the exceptions
+        const uint64_t data_codes_size = values_size + exceptions_size;
+        return CompressedSizeInfo{
+            symbol_table_size + data_codes_size + exception_index_size,
+            {
+                symbol_table_size, // size_dictionary_strings
+                0, // size_dictionary_lengths
+                symbol_table_size, // size_dictionary
+                data_codes_size, // size_data_codes
+                exception_index_size, // size_data_lengths
+                data_codes_size + exception_index_size // size_data
+            },
+            symbol_table_size // size_fixed
+        };
+    }
+
+    static CompressedSizeInfo Template(uint64_t literals_size, uint64_t literal_lengths_size,
+                                       uint64_t symbol_tables_size, uint64_t template_ids_size, uint64_t slots_size) {
+        // the templates and the symbol tables of their slot columns are the dictionary, the template of every row
+        // and its slot values the data. The slot columns store their own lengths
+        const uint64_t dictionary_strings_size = literals_size + symbol_tables_size;
+        const uint64_t dictionary_size = dictionary_strings_size + literal_lengths_size;
+        const uint64_t data_codes_size = template_ids_size + slots_size;
+        constexpr uint64_t data_lengths_size = 0;
+        return CompressedSizeInfo{
+            dictionary_size + data_codes_size,
+            {
+                dictionary_strings_size, // size_dictionary_strings
+                literal_lengths_size, // size_dictionary_lengths
+                dictionary_size, // size_dictionary
+                data_codes_size, // size_data_codes
+                data_lengths_size, // size_data_lengths
+                data_codes_size + data_lengths_size // size_data
+            },
+            dictionary_size // size_fixed
+        };
+    }
+
+    static CompressedSizeInfo FMIndex(uint64_t bwt_size, uint64_t samples_size, uint64_t data_lengths_size) {
+        // a self-index: the runs of the BWT and their rank structures are the data, the suffix array samples are
+        // counted as its dictionary
+        constexpr uint64_t dictionary_lengths_size = 0;
+
+        return CompressedSizeInfo{
+            bwt_size + samples_size + data_lengths_size,
+            {
+                samples_size, // size_dictionary_strings
+                dictionary_lengths_size, // size_dictionary_lengths
+                samples_size, // size_dictionary
+                bwt_size, // size_data_codes
+                data_lengths_size, // size_data_lengths
+                bwt_size + data_lengths_size // size_data
+            }
+        };
+    }
+};
+
+
+// Sub-phases of compressing a row group, reported by the algorithms that can tell them apart
+enum class CompressionPhase {
+    Sample, // drawing the sample a symbol table is trained on
+    Train, // building the symbol table or dictionary
+    Encode, // encoding the strings
+    Finalize, // everything after encoding, e.g. creating the decoder
+    Synopses, // building the per-vector synopses, by the benchmark for every algorithm
+};
+
+struct CompressionPhaseTimes {
+    double sample_ms;
+    double train_ms;
+    double encode_ms;
+    double finalize_ms;
+    double synopses_ms;
+
+    double &operator[](const CompressionPhase phase) {
+        switch (phase) {
+            case CompressionPhase::Sample: return sample_ms;
+            case CompressionPhase::Train: return train_ms;
+            case CompressionPhase::Encode: return encode_ms;
+            case CompressionPhase::Finalize: return finalize_ms;
+            case CompressionPhase::Synopses: return synopses_ms;
+        }
+        ErrorHandler::HandleLogicError("Unknown compression phase");
+        return finalize_ms;
+    }
+
+    CompressionPhaseTimes &operator+=(const CompressionPhaseTimes &other) {
+        sample_ms += other.sample_ms;
+        train_ms += other.train_ms;
+        encode_ms += other.encode_ms;
+        finalize_ms += other.finalize_ms;
+        synopses_ms += other.synopses_ms;
+        return *this;
+    }
+
+    CompressionPhaseTimes &operator/=(const double n) {
+        sample_ms /= n;
+        train_ms /= n;
+        encode_ms /= n;
+        finalize_ms /= n;
+        synopses_ms /= n;
+        return *this;
+    }
+};
+
+struct SymbolTableReuseInfo {
+    // whether the row group was compressed with a symbol table trained on an earlier row group of the column
+    bool reused;
+    // whether the reused table compressed too badly, so the row group trained a new one after all
+    bool retrained;
+    // fraction of the codes that are escaped bytes (single-byte codes for FSST12) with the final table
+    double escape_rate;
+    // ratio of the data codes relative to the ratio on the row group the table was trained on, minus 1
+    double ratio_drift;
 };
 
+// Lookups of decompressed blocks in the block cache of the block codecs, zero for the other algorithms
+struct BlockCacheCounters {
+    uint64_t hits;
+    uint64_t misses;
+
+    [[nodiscard]] double HitRate() const {
+        const uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+
+    BlockCacheCounters operator-(const BlockCacheCounters &other) const {
+        return {hits - other.hits, misses - other.misses};
+    }
+};
+
+// Single-row decompression under one access pattern
+struct AccessPatternStats {
+    BlockCacheCounters block_cache;
+    // decompression time per row
+    double lookup_latency_ns;
+};
+
+// Decompression handing out views of the strings instead of copying them, for the algorithms that have views
+struct ViewDecompressionStats {
+    // whether the algorithm has views of all rows and of single rows, the times are zero for those it has not
+    bool full;
+    bool rows;
+    double time_ms_full;
+    double time_ms_vector;
+    double time_ms_random;
+    // lookups in the block cache during the view phases, which start as cold as the copying ones
+    BlockCacheCounters block_cache_vector;
+    BlockCacheCounters block_cache_random;
+};
+
+// How the choice of AutoSelect compares with the best candidate measured on the full row group. The predicted choice
+// is the chosen scheme of the result, the time spent choosing its sample phase
+struct AutoSelectInfo {
+    // empty if the candidates were not measured on the full row group
+    std::string best;
+    // cost of the predicted minus cost of the best candidate under the same cost model, 0 if the prediction was right
+    double regret;
+};
+
+// The query phases, run with --queries. Algorithms without compressed-domain kernels decompress the row group for
+// every query, their times include the decompression
+struct QueryStats {
+    // the queries the algorithm answered on its compressed data, e.g. "filter;group_by"
+    std::string on_codes;
+    // the instruction set the filter and range kernels scanned the codes with, empty without them
+    std::string scan_kernel;
+    // rows the equality predicate of the filter phase selected
+    uint64_t filter_rows;
+    double filter_time_ms;
+    // rows the range predicate selected
+    uint64_t range_rows;
+    double range_time_ms;
+    // min and max of every vector
+    double min_max_time_ms;
+    // the rows in the order of their strings
+    double sort_time_ms;
+    // the number of rows of every distinct string
+    uint64_t group_by_groups;
+    double group_by_time_ms;
+    // rows containing a substring of one of the random rows
+    uint64_t contains_rows;
+    double contains_time_ms;
+
+    // the rows joined with themselves on equal strings: pairs of matching rows, the times of building and probing the
+    // hash table and the bytes of its distinct keys. Keyed on the compressed strings if on_codes has hash_join
+    uint64_t hash_join_matches;
+    // the time of getting the keys: the compressed strings, or the decompression without them. Not part of the build
+    double hash_join_keys_time_ms;
+    double hash_join_build_time_ms;
+    double hash_join_probe_time_ms;
+    uint64_t hash_join_key_bytes;
+    // the same join keyed on the decompressed strings, without the decompression
+    double hash_join_string_build_time_ms;
+    double hash_join_string_probe_time_ms;
+    uint64_t hash_join_string_key_bytes;
+    // with synopses: the vectors of the row group and how many the filter and range predicates skipped. Zero with
+    // kernels, which do not need them
+    uint64_t n_vectors;
+    uint64_t filter_vectors_skipped;
+    uint64_t range_vectors_skipped;
+    // with synopses: equality lookups decompressing the vectors the synopses do not rule out, and the same lookups
+    // decompressing the row group
+    uint64_t lookups;
+    uint64_t lookup_vectors_skipped;
+    double lookup_time_ms;
+    double lookup_time_ms_without_synopses;
+
+    [[nodiscard]] double GroupsPerSecond() const {
+        return group_by_time_ms == 0.0 ? 0.0 : static_cast<double>(group_by_groups) * 1000.0 / group_by_time_ms;
+    }
+
+    [[nodiscard]] double LookupsPerSecond() const {
+        return lookup_time_ms == 0.0 ? 0.0 : static_cast<double>(lookups) * 1000.0 / lookup_time_ms;
+    }
+
+    // the share of the vectors the lookups skipped
+    [[nodiscard]] double LookupSkipRate() const {
+        const uint64_t n_checked = lookups * n_vectors;
+        return n_checked == 0 ? 0.0 : static_cast<double>(lookup_vectors_skipped) / static_cast<double>(n_checked);
+    }
+
+    // how much faster the join is on the keys it used than on the strings
+    [[nodiscard]] double HashJoinSpeedup() const {
+        const double time_ms = hash_join_build_time_ms + hash_join_probe_time_ms;
+        return time_ms == 0.0 ? 0.0 : (hash_join_string_build_time_ms + hash_join_string_probe_time_ms) / time_ms;
+    }
+};
 
 struct AlgorithmResult {
     AlgorithType algorithm;
@@ -145,13 +504,36 @@ struct AlgorithmResult {
     std::string error_message;
 
     double compression_time_ms;
+    // the parts of compression_time_ms spent in each phase, zero for algorithms that cannot tell them apart. Their sum
+    // stays below compression_time_ms, as e.g. preparing the input belongs to no phase
+    CompressionPhaseTimes compression_phase_times;
     double decompression_time_ms_full;
     double decompression_time_ms_vector;
     double decompression_time_ms_random;
+    // N_RANDOM_UNSORTED_ROW_ACCESSES of the random rows, shuffled so that consecutive lookups jump between blocks. Fewer
+    // rows than decompression_time_ms_random, access_random_unsorted has the time per row to compare
+    double decompression_time_ms_random_unsorted;
 
     uint64_t decompression_hash_full;
     uint64_t decompression_hash_vector;
     uint64_t decompression_hash_random;
+
+    SymbolTableReuseInfo symbol_table_reuse;
+
+    // runtime parameters of the algorithm, empty if it has none
+    std::string parameters;
+    // scheme an adaptive algorithm chose for this row group, e.g. the cascade of Cascade
+    std::string chosen_scheme;
+
+    AccessPatternStats access_random;
+    AccessPatternStats access_vector;
+    AccessPatternStats access_random_unsorted;
+
+    AutoSelectInfo auto_select;
+
+    QueryStats queries;
+
+    ViewDecompressionStats views;
 };
 
 inline AlgorithmResult MeanTimes(const std::vector<AlgorithmResult> &results) {
@@ -166,26 +548,119 @@ inline AlgorithmResult MeanTimes(const std::vector<AlgorithmResult> &results) {
     double n = static_cast<double>(results.size());
 
     mean.compression_time_ms = 0.0;
+    mean.compression_phase_times = {};
     mean.decompression_time_ms_full = 0.0;
     mean.decompression_time_ms_vector = 0.0;
     mean.decompression_time_ms_random = 0.0;
-
+    mean.decompression_time_ms_random_unsorted = 0.0;
+    mean.views.time_ms_full = 0.0;
+    mean.views.time_ms_vector = 0.0;
+    mean.views.time_ms_random = 0.0;
+    mean.access_random.lookup_latency_ns = 0.0;
+    mean.access_vector.lookup_latency_ns = 0.0;
+    mean.access_random_unsorted.lookup_latency_ns = 0.0;
+    mean.queries.filter_time_ms = 0.0;
+    mean.queries.range_time_ms = 0.0;
+    mean.queries.min_max_time_ms = 0.0;
+    mean.queries.sort_time_ms = 0.0;
+    mean.queries.group_by_time_ms = 0.0;
+    mean.queries.contains_time_ms = 0.0;
+    mean.queries.hash_join_keys_time_ms = 0.0;
+    mean.queries.hash_join_build_time_ms = 0.0;
+    mean.queries.hash_join_probe_time_ms = 0.0;
+    mean.queries.hash_join_string_build_time_ms = 0.0;
+    mean.queries.hash_join_string_probe_time_ms = 0.0;
+    mean.queries.lookup_time_ms = 0.0;
+    mean.queries.lookup_time_ms_without_synopses = 0.0;
 
     for (const auto &r: results) {
         mean.compression_time_ms += r.compression_time_ms;
+        mean.compression_phase_times += r.compression_phase_times;
         mean.decompression_time_ms_full += r.decompression_time_ms_full;
         mean.decompression_time_ms_vector += r.decompression_time_ms_vector;
         mean.decompression_time_ms_random += r.decompression_time_ms_random;
+        mean.decompression_time_ms_random_unsorted += r.decompression_time_ms_random_unsorted;
+        mean.views.time_ms_full += r.views.time_ms_full;
+        mean.views.time_ms_vector += r.views.time_ms_vector;
+        mean.views.time_ms_random += r.views.time_ms_random;
+        mean.access_random.lookup_latency_ns += r.access_random.lookup_latency_ns;
+        mean.access_vector.lookup_latency_ns += r.access_vector.lookup_latency_ns;
+        mean.access_random_unsorted.lookup_latency_ns += r.access_random_unsorted.lookup_latency_ns;
+        mean.queries.filter_time_ms += r.queries.filter_time_ms;
+        mean.queries.range_time_ms += r.queries.range_time_ms;
+        mean.queries.min_max_time_ms += r.queries.min_max_time_ms;
+        mean.queries.sort_time_ms += r.queries.sort_time_ms;
+        mean.queries.group_by_time_ms += r.queries.group_by_time_ms;
+        mean.queries.contains_time_ms += r.queries.contains_time_ms;
+        mean.queries.hash_join_keys_time_ms += r.queries.hash_join_keys_time_ms;
+        mean.queries.hash_join_build_time_ms += r.queries.hash_join_build_time_ms;
+        mean.queries.hash_join_probe_time_ms += r.queries.hash_join_probe_time_ms;
+        mean.queries.hash_join_string_build_time_ms += r.queries.hash_join_string_build_time_ms;
+        mean.queries.hash_join_string_probe_time_ms += r.queries.hash_join_string_probe_time_ms;
+        mean.queries.lookup_time_ms += r.queries.lookup_time_ms;
+        mean.queries.lookup_time_ms_without_synopses += r.queries.lookup_time_ms_without_synopses;
     }
 
     mean.compression_time_ms /= n;
+    mean.compression_phase_times /= n;
     mean.decompression_time_ms_full /= n;
     mean.decompression_time_ms_vector /= n;
     mean.decompression_time_ms_random /= n;
+    mean.decompression_time_ms_random_unsorted /= n;
+    mean.views.time_ms_full /= n;
+    mean.views.time_ms_vector /= n;
+    mean.views.time_ms_random /= n;
+    mean.access_random.lookup_latency_ns /= n;
+    mean.access_vector.lookup_latency_ns /= n;
+    mean.access_random_unsorted.lookup_latency_ns /= n;
+    mean.queries.filter_time_ms /= n;
+    mean.queries.range_time_ms /= n;
+    mean.queries.min_max_time_ms /= n;
+    mean.queries.sort_time_ms /= n;
+    mean.queries.group_by_time_ms /= n;
+    mean.queries.contains_time_ms /= n;
+    mean.queries.hash_join_keys_time_ms /= n;
+    mean.queries.hash_join_build_time_ms /= n;
+    mean.queries.hash_join_probe_time_ms /= n;
+    mean.queries.hash_join_string_build_time_ms /= n;
+    mean.queries.hash_join_string_probe_time_ms /= n;
+    mean.queries.lookup_time_ms /= n;
+    mean.queries.lookup_time_ms_without_synopses /= n;
 
     return mean;
 }
 
+// Features of the strings of a row group, the same for all algorithms
+struct ColumnProfile {
+    static constexpr size_t N_LENGTH_BUCKETS = 12;
+
+    // strings per length bucket: bucket 0 holds empty strings, bucket b lengths in [2^(b-1), 2^b), the last one all
+    // longer strings
+    std::array<uint64_t, N_LENGTH_BUCKETS> length_histogram;
+    // HyperLogLog estimate of the number of distinct strings
+    double distinct_count;
+    // Shannon entropy of the bytes in bits per byte
+    double byte_entropy;
+    // share of the strings held by the most frequent ones (a lower bound, see ProfileColumn)
+    double top_k_share;
+    // share of the bytes below 128
+    double ascii_fraction;
+    // fraction of neighbouring strings in ascending order
+    double sortedness;
+    // average length of the prefix a string shares with the one before it
+    double avg_common_prefix;
+    // time the profile took
+    double profile_time_ms;
+
+    [[nodiscard]] std::string LengthHistogramString() const {
+        std::string histogram;
+        for (size_t bucket = 0; bucket < N_LENGTH_BUCKETS; bucket++) {
+            histogram += (bucket == 0 ? "" : ";") + std::to_string(length_histogram[bucket]);
+        }
+        return histogram;
+    }
+};
+
 class ExperimentResult {
 public:
     explicit ExperimentResult(
@@ -209,6 +684,7 @@ public:
     }
 
     void setUncompressedSize(uint64_t size) { uncompressed_size_ = size; }
+    void SetProfile(const ColumnProfile &profile) { profile_ = profile; }
     uint64_t GetUncompressedSize() const { return uncompressed_size_; }
     uint64_t GetUncompressedSizeStrings() const { return uncompressed_size_strings_; }
     uint64_t GetUncompressedSizeLengths() const { return uncompressed_size_lengths_; }
@@ -216,6 +692,7 @@ public:
     uint64_t GetNumRowsNotEmpty() const { return n_rows_not_empty_; }
     uint64_t GetRowGroupIdx() const { return row_group_idx_; }
     uint64_t GetRowsOffset() const { return rows_offset_; }
+    const ColumnProfile &GetProfile() const { return profile_; }
 
     void AddResult(const AlgorithmResult &res) {
         results_.push_back(res);
@@ -259,6 +736,7 @@ private:
     uint64_t uncompressed_size_;
     uint64_t uncompressed_size_strings_;
     uint64_t uncompressed_size_lengths_;
+    ColumnProfile profile_{};
     std::vector<AlgorithmResult> results_;
 };
 
@@ -271,10 +749,27 @@ inline bool SaveResultsAsCSV(const std::vector<ExperimentResult> &experiments,
     // Header
     out <<
             "table,column,row_offset,row_group_idx,uncompressed_size,uncompressed_size_strings,uncompressed_size_lengths,"
-            "n_rows,n_rows_not_empty,algorithm,compressed_size,"
+            "n_rows,n_rows_not_empty,sortedness,distinct_count_estimate,byte_entropy,top_k_share,ascii_fraction,"
+            "avg_common_prefix,length_histogram,profile_time_ms,algorithm,parameters,chosen_scheme,compressed_size,"
             "compressed_size_dictionary_strings,compressed_size_dictionary_lengths,compressed_size_dictionary,size_data_codes,compressed_size_data_lengths,compressed_size_data,"
-            "compression_time_ms,decompression_time_ms_full,decompression_time_ms_vector,decompression_time_ms_random,"
-            "decompression_hash_full,decompression_hash_vector,decompression_hash_random,hasError,errorMessage\n";
+            "compressed_size_synopses,"
+            "compression_time_ms,compression_time_ms_sample,compression_time_ms_train,compression_time_ms_encode,compression_time_ms_finalize,"
+            "compression_time_ms_synopses,"
+            "decompression_time_ms_full,decompression_time_ms_vector,decompression_time_ms_random,decompression_time_ms_random_unsorted,"
+            "decompression_views_full,decompression_views_rows,decompression_time_ms_full_views,decompression_time_ms_vector_views,decompression_time_ms_random_views,"
+            "block_cache_hit_rate_vector_views,block_cache_hit_rate_random_views,"
+            "decompression_hash_full,decompression_hash_vector,decompression_hash_random,"
+            "symbol_table_reused,symbol_table_retrained,escape_rate,compression_ratio_drift,"
+            "block_cache_hit_rate_random,block_cache_hit_rate_vector,block_cache_hit_rate_random_unsorted,"
+            "lookup_latency_ns_random,lookup_latency_ns_vector,lookup_latency_ns_random_unsorted,"
+            "auto_select_best,auto_select_regret,"
+            "query_on_codes,query_scan_kernel,query_filter_rows,query_time_ms_filter,query_range_rows,query_time_ms_range,query_time_ms_min_max,query_time_ms_sort,"
+            "query_group_by_groups,query_time_ms_group_by,query_group_by_groups_per_s,query_contains_rows,query_time_ms_contains,"
+            "query_hash_join_matches,query_time_ms_hash_join_keys,query_time_ms_hash_join_build,query_time_ms_hash_join_probe,query_hash_join_key_bytes,"
+            "query_time_ms_hash_join_build_strings,query_time_ms_hash_join_probe_strings,query_hash_join_key_bytes_strings,"
+            "query_hash_join_speedup,query_n_vectors,query_filter_vectors_skipped,query_range_vectors_skipped,"
+            "query_lookups,query_lookup_vectors_skipped,query_lookup_skip_rate,query_time_ms_lookup,"
+            "query_time_ms_lookup_without_synopses,query_lookups_per_s,hasError,errorMessage\n";
 
     out << std::fixed << std::setprecision(6); // times to 3 decimals
 
@@ -299,7 +794,17 @@ inline bool SaveResultsAsCSV(const std::vector<ExperimentResult> &experiments,
                     << exp.GetUncompressedSizeLengths() << ','
                     << exp.GetNumRows() << ','
                     << exp.GetNumRowsNotEmpty() << ','
+                    << exp.GetProfile().sortedness << ','
+                    << exp.GetProfile().distinct_count << ','
+                    << exp.GetProfile().byte_entropy << ','
+                    << exp.GetProfile().top_k_share << ','
+                    << exp.GetProfile().ascii_fraction << ','
+                    << exp.GetProfile().avg_common_prefix << ','
+                    << CSVEscape(exp.GetProfile().LengthHistogramString()) << ','
+                    << exp.GetProfile().profile_time_ms << ','
                     << CSVEscape(ToString(ar.algorithm)) << ','
+                    << CSVEscape(ar.parameters) << ','
+                    << CSVEscape(ar.chosen_scheme) << ','
                     << ar.compressed_size_info.compressed_size << ','
                     << ar.compressed_size_info.parts.size_dictionary_strings << ','
                     << ar.compressed_size_info.parts.size_dictionary_lengths << ','
@@ -307,13 +812,70 @@ inline bool SaveResultsAsCSV(const std::vector<ExperimentResult> &experiments,
                     << ar.compressed_size_info.parts.size_data_codes << ','
                     << ar.compressed_size_info.parts.size_data_lengths << ','
                     << ar.compressed_size_info.parts.size_data << ','
+                    << ar.compressed_size_info.size_synopses << ','
                     << ar.compression_time_ms << ','
+                    << ar.compression_phase_times.sample_ms << ','
+                    << ar.compression_phase_times.train_ms << ','
+                    << ar.compression_phase_times.encode_ms << ','
+                    << ar.compression_phase_times.finalize_ms << ','
+                    << ar.compression_phase_times.synopses_ms << ','
                     << ar.decompression_time_ms_full << ','
                     << ar.decompression_time_ms_vector << ','
                     << ar.decompression_time_ms_random << ','
+                    << ar.decompression_time_ms_random_unsorted << ','
+                    << ar.views.full << ','
+                    << ar.views.rows << ','
+                    << ar.views.time_ms_full << ','
+                    << ar.views.time_ms_vector << ','
+                    << ar.views.time_ms_random << ','
+                    << ar.views.block_cache_vector.HitRate() << ','
+                    << ar.views.block_cache_random.HitRate() << ','
                     << ar.decompression_hash_full << ','
                     << ar.decompression_hash_vector << ','
                     << ar.decompression_hash_random << ','
+                    << ar.symbol_table_reuse.reused << ','
+                    << ar.symbol_table_reuse.retrained << ','
+                    << ar.symbol_table_reuse.escape_rate << ','
+                    << ar.symbol_table_reuse.ratio_drift << ','
+                    << ar.access_random.block_cache.HitRate() << ','
+                    << ar.access_vector.block_cache.HitRate() << ','
+                    << ar.access_random_unsorted.block_cache.HitRate() << ','
+                    << ar.access_random.lookup_latency_ns << ','
+                    << ar.access_vector.lookup_latency_ns << ','
+                    << ar.access_random_unsorted.lookup_latency_ns << ','
+                    << CSVEscape(ar.auto_select.best) << ','
+                    << ar.auto_select.regret << ','
+                    << CSVEscape(ar.queries.on_codes) << ','
+                    << ar.queries.scan_kernel << ','
+                    << ar.queries.filter_rows << ','
+                    << ar.queries.filter_time_ms << ','
+                    << ar.queries.range_rows << ','
+                    << ar.queries.range_time_ms << ','
+                    << ar.queries.min_max_time_ms << ','
+                    << ar.queries.sort_time_ms << ','
+                    << ar.queries.group_by_groups << ','
+                    << ar.queries.group_by_time_ms << ','
+                    << ar.queries.GroupsPerSecond() << ','
+                    << ar.queries.contains_rows << ','
+                    << ar.queries.contains_time_ms << ','
+                    << ar.queries.hash_join_matches << ','
+                    << ar.queries.hash_join_keys_time_ms << ','
+                    << ar.queries.hash_join_build_time_ms << ','
+                    << ar.queries.hash_join_probe_time_ms << ','
+                    << ar.queries.hash_join_key_bytes << ','
+                    << ar.queries.hash_join_string_build_time_ms << ','
+                    << ar.queries.hash_join_string_probe_time_ms << ','
+                    << ar.queries.hash_join_string_key_bytes << ','
+                    << ar.queries.HashJoinSpeedup() << ','
+                    << ar.queries.n_vectors << ','
+                    << ar.queries.filter_vectors_skipped << ','
+                    << ar.queries.range_vectors_skipped << ','
+                    << ar.queries.lookups << ','
+                    << ar.queries.lookup_vectors_skipped << ','
+                    << ar.queries.LookupSkipRate() << ','
+                    << ar.queries.lookup_time_ms << ','
+                    << ar.queries.lookup_time_ms_without_synopses << ','
+                    << ar.queries.LookupsPerSecond() << ','
                     << ar.has_error << ','
                     << ar.error_message << '\n';
         }
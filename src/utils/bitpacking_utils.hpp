@@ -1,6 +1,8 @@
 # pragma once
 #include <duckdb.h>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 
 
@@ -27,4 +29,28 @@ public:
         return GetCompressedSize(range, values.size());
     }
 
+    // packs the values with bits_per_value bits each, followed by PACKING_PADDING bytes so Unpack can always load
+    // a full word. bits_per_value must be at most 56
+    template <typename T>
+    static std::vector<uint8_t> Pack(const std::vector<T>& values, const uint8_t bits_per_value) {
+        std::vector<uint8_t> packed((values.size() * bits_per_value + 7) / 8 + PACKING_PADDING, 0);
+        for (size_t i = 0; i < values.size(); i++) {
+            const size_t bit_position = i * bits_per_value;
+            uint64_t word;
+            std::memcpy(&word, packed.data() + bit_position / 8, sizeof(word));
+            word |= static_cast<uint64_t>(values[i]) << (bit_position % 8);
+            std::memcpy(packed.data() + bit_position / 8, &word, sizeof(word));
+        }
+        return packed;
+    }
+
+    static uint64_t Unpack(const uint8_t *packed, const uint8_t bits_per_value, const size_t index) {
+        const size_t bit_position = index * bits_per_value;
+        uint64_t word;
+        std::memcpy(&word, packed + bit_position / 8, sizeof(word));
+        return (word >> (bit_position % 8)) & ((uint64_t{1} << bits_per_value) - 1);
+    }
+
+    static constexpr size_t PACKING_PADDING = 8;
+
 };
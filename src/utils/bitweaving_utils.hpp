@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "bitpacking_utils.hpp"
+#include "cpu_features.hpp"
+
+// Dictionary codes packed BitWeaving/H style for predicate scans: every code takes bits_per_code bits plus a delimiter
+// bit above them that is 0, a 64-bit word holds as many codes as fit. Subtracting a word of replicated constants then
+// leaves the delimiter bit of a code set iff the code is at least the constant, with no borrow into the next code, so
+// one subtraction compares all codes of a word. AVX2 and AVX-512 compare 4 and 8 words per instruction, the delimiter
+// bits become bits of the result bitmap with pext. The scan uses the widest of them the CPU has
+class WovenCodes {
+public:
+    // the instruction set the scans run with on this CPU
+    static const char *Kernel() {
+        if (CpuFeatures::HasAvx512()) return "avx512";
+        if (CpuFeatures::HasAvx2()) return "avx2";
+        return "scalar";
+    }
+
+    void Pack(const std::vector<uint32_t> &codes, const size_t n_codes) {
+        n_rows_ = codes.size();
+        bits_per_code_ = BitPackingUtils::GetBitsPerValue(n_codes == 0 ? 0 : n_codes - 1);
+        field_bits_ = bits_per_code_ + 1;
+        codes_per_word_ = 64 / field_bits_;
+        delimiters_ = Replicate(uint64_t{1} << bits_per_code_);
+
+        // a whole number of AVX-512 iterations, the codes of the padding are never reported
+        const size_t n_words = (n_rows_ + codes_per_word_ - 1) / codes_per_word_;
+        words_.assign((n_words + WORDS_PER_ITERATION - 1) / WORDS_PER_ITERATION * WORDS_PER_ITERATION, 0);
+        for (size_t i = 0; i < n_rows_; i++) {
+            words_[i / codes_per_word_] |= static_cast<uint64_t>(codes[i]) << (i % codes_per_word_ * field_bits_);
+        }
+    }
+
+    // bitmap of the rows whose code c satisfies low <= c <= high, bit i % 64 of word i / 64 for row i
+    void FilterRange(const uint32_t low, const uint32_t high, std::vector<uint64_t> &bitmap) const {
+        if (low > high || n_rows_ == 0) {
+            bitmap.assign(BitmapWords(), 0);
+            return;
+        }
+        // room for the bits of the padding
+        bitmap.assign(words_.size() * codes_per_word_ / 64 + 2, 0);
+        const uint64_t lows = Replicate(low);
+        const uint64_t highs = Replicate(high) | delimiters_;
+#if defined(CPU_FEATURES_X86)
+        if (CpuFeatures::HasAvx512()) {
+            ScanAvx512(lows, highs, bitmap);
+        } else if (CpuFeatures::HasAvx2()) {
+            ScanAvx2(lows, highs, bitmap);
+        } else
+#endif
+        {
+            ScanScalar(lows, highs, bitmap);
+        }
+        // the padding codes are 0, they may have matched
+        bitmap.resize(BitmapWords());
+        if (n_rows_ % 64 != 0) {
+            bitmap.back() &= (uint64_t{1} << (n_rows_ % 64)) - 1;
+        }
+    }
+
+    // the rows of the set bits, ascending
+    static void BitmapToRows(const std::vector<uint64_t> &bitmap, std::vector<uint32_t> &rows) {
+        size_t n_rows = 0;
+        for (const uint64_t word: bitmap) {
+            n_rows += __builtin_popcountll(word);
+        }
+        rows.resize(n_rows);
+        size_t row_idx = 0;
+        for (size_t word = 0; word < bitmap.size(); word++) {
+            uint64_t bits = bitmap[word];
+            while (bits != 0) {
+                rows[row_idx++] = static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        return (n_rows_ + codes_per_word_ - 1) / codes_per_word_ * sizeof(uint64_t);
+    }
+
+    void Clear() {
+        words_.clear();
+        n_rows_ = 0;
+    }
+
+private:
+    static constexpr size_t WORDS_PER_ITERATION = 8;
+
+    [[nodiscard]] size_t BitmapWords() const {
+        return (n_rows_ + 63) / 64;
+    }
+
+    // the value in every code of a word
+    [[nodiscard]] uint64_t Replicate(const uint64_t value) const {
+        uint64_t word = 0;
+        for (size_t i = 0; i < codes_per_word_; i++) {
+            word |= value << (i * field_bits_);
+        }
+        return word;
+    }
+
+    // the scans set the delimiter bit of every matching code of a word and append the delimiter bits to the bitmap
+    void ScanScalar(const uint64_t lows, const uint64_t highs, std::vector<uint64_t> &bitmap) const {
+        for (size_t word = 0; word < words_.size(); word++) {
+            const uint64_t x = words_[word];
+            const uint64_t matches = ((x | delimiters_) - lows) & (highs - x) & delimiters_;
+            uint64_t bits = 0;
+            for (size_t i = 0; i < codes_per_word_; i++) {
+                bits |= (matches >> (i * field_bits_ + bits_per_code_) & 1) << i;
+            }
+            AppendBits(bitmap, word * codes_per_word_, bits);
+        }
+    }
+
+#if defined(CPU_FEATURES_X86)
+    TARGET_AVX2 void ScanAvx2(const uint64_t lows, const uint64_t highs, std::vector<uint64_t> &bitmap) const {
+        const __m256i d = _mm256_set1_epi64x(static_cast<long long>(delimiters_));
+        const __m256i l = _mm256_set1_epi64x(static_cast<long long>(lows));
+        const __m256i h = _mm256_set1_epi64x(static_cast<long long>(highs));
+        alignas(32) uint64_t matches[4];
+        for (size_t word = 0; word < words_.size(); word += 4) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words_.data() + word));
+            const __m256i at_least_low = _mm256_sub_epi64(_mm256_or_si256(x, d), l);
+            const __m256i at_most_high = _mm256_sub_epi64(h, x);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(matches), _mm256_and_si256(_mm256_and_si256(at_least_low, at_most_high), d));
+            for (size_t i = 0; i < 4; i++) {
+                AppendBits(bitmap, (word + i) * codes_per_word_, _pext_u64(matches[i], delimiters_));
+            }
+        }
+    }
+
+    TARGET_AVX512 void ScanAvx512(const uint64_t lows, const uint64_t highs, std::vector<uint64_t> &bitmap) const {
+        const __m512i d = _mm512_set1_epi64(static_cast<long long>(delimiters_));
+        const __m512i l = _mm512_set1_epi64(static_cast<long long>(lows));
+        const __m512i h = _mm512_set1_epi64(static_cast<long long>(highs));
+        alignas(64) uint64_t matches[WORDS_PER_ITERATION];
+        for (size_t word = 0; word < words_.size(); word += WORDS_PER_ITERATION) {
+            const __m512i x = _mm512_loadu_si512(words_.data() + word);
+            const __m512i at_least_low = _mm512_sub_epi64(_mm512_or_si512(x, d), l);
+            const __m512i at_most_high = _mm512_sub_epi64(h, x);
+            _mm512_store_si512(matches, _mm512_and_si512(_mm512_and_si512(at_least_low, at_most_high), d));
+            for (size_t i = 0; i < WORDS_PER_ITERATION; i++) {
+                AppendBits(bitmap, (word + i) * codes_per_word_, _pext_u64(matches[i], delimiters_));
+            }
+        }
+    }
+#endif
+
+    // at most 32 bits, as codes take at least 2 bits
+    static void AppendBits(std::vector<uint64_t> &bitmap, const size_t position, const uint64_t bits) {
+        const size_t shift = position % 64;
+        bitmap[position / 64] |= bits << shift;
+        if (shift != 0) {
+            bitmap[position / 64 + 1] |= bits >> (64 - shift);
+        }
+    }
+
+    std::vector<uint64_t> words_;
+    size_t n_rows_{0};
+    uint8_t bits_per_code_{1};
+    size_t field_bits_{2};
+    size_t codes_per_word_{32};
+    uint64_t delimiters_{0};
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "string_utils.hpp"
+#include "../models/compression_result.hpp"
+#include "../models/string_collection.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// registers of the HyperLogLog sketch: 2^12, a standard error of about 1.6%
+constexpr uint8_t PROFILE_HLL_PRECISION = 12;
+// the share of the PROFILE_TOP_K most frequent strings is counted with PROFILE_TOP_K_COUNTERS Misra-Gries counters
+constexpr size_t PROFILE_TOP_K = 10;
+constexpr size_t PROFILE_TOP_K_COUNTERS = 64;
+
+// Distinct count estimate of a stream of 64-bit hashes
+class HyperLogLog {
+public:
+    HyperLogLog() : registers_(size_t{1} << PROFILE_HLL_PRECISION, 0) {
+    }
+
+    inline void Add(const uint64_t hash) {
+        const size_t register_idx = hash >> (64 - PROFILE_HLL_PRECISION);
+        // position of the first set bit of the remaining bits, the marker bit ends the search at the last one
+        const uint64_t remaining = (hash << PROFILE_HLL_PRECISION) | (uint64_t{1} << (PROFILE_HLL_PRECISION - 1));
+        const auto rank = static_cast<uint8_t>(__builtin_clzll(remaining) + 1);
+        registers_[register_idx] = std::max(registers_[register_idx], rank);
+    }
+
+    [[nodiscard]] double Estimate() const {
+        const auto m = static_cast<double>(registers_.size());
+        double inverse_sum = 0.0;
+        size_t n_zero_registers = 0;
+        for (const uint8_t value: registers_) {
+            inverse_sum += std::ldexp(1.0, -value);
+            n_zero_registers += value == 0;
+        }
+        const double estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / inverse_sum;
+        // small cardinalities leave registers empty, linear counting is more accurate for them
+        if (estimate <= 2.5 * m && n_zero_registers > 0) {
+            return m * std::log(m / static_cast<double>(n_zero_registers));
+        }
+        return estimate;
+    }
+
+private:
+    std::vector<uint8_t> registers_;
+};
+
+// Profiles the strings of a row group in a single pass. The top-k share comes from Misra-Gries counters, which
+// undercount every string by at most n / (PROFILE_TOP_K_COUNTERS + 1) and keep the memory bounded. Sortedness and
+// common prefixes compare neighbouring strings 16 bytes at a time with CommonPrefixLength, the byte histogram is
+// scalar and spread over four tables instead
+inline ColumnProfile ProfileColumn(const StringCollector &collector) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    ColumnProfile profile{};
+    const size_t n = collector.Size();
+    const auto pointers = collector.GetPointers();
+
+    HyperLogLog distinct;
+    robin_hood::unordered_flat_map<uint64_t, uint64_t> frequent;
+    frequent.reserve(PROFILE_TOP_K_COUNTERS + 1);
+    // four tables, so the counts of neighbouring equal bytes do not wait on each other
+    std::array<std::array<uint32_t, 256>, 4> byte_counts{};
+    size_t n_ordered = 0;
+    size_t total_prefix_length = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *str = pointers[i];
+        const size_t length = pointers[i + 1] - pointers[i];
+
+        const size_t bucket = length == 0 ? 0 : std::min<size_t>(64 - __builtin_clzll(length), ColumnProfile::N_LENGTH_BUCKETS - 1);
+        profile.length_histogram[bucket]++;
+
+        const uint64_t hash = robin_hood::hash_bytes(str, length);
+        distinct.Add(hash);
+        if (auto it = frequent.find(hash); it != frequent.end()) {
+            it->second++;
+        } else if (frequent.size() < PROFILE_TOP_K_COUNTERS) {
+            frequent.emplace(hash, 1);
+        } else {
+            // no counter left: every counter loses one, the ones that reach zero are freed
+            for (auto counter = frequent.begin(); counter != frequent.end();) {
+                counter = --counter->second == 0 ? frequent.erase(counter) : std::next(counter);
+            }
+        }
+
+        size_t pos = 0;
+        for (; pos + 4 <= length; pos += 4) {
+            byte_counts[0][str[pos]]++;
+            byte_counts[1][str[pos + 1]]++;
+            byte_counts[2][str[pos + 2]]++;
+            byte_counts[3][str[pos + 3]]++;
+        }
+        for (; pos < length; pos++) {
+            byte_counts[0][str[pos]]++;
+        }
+
+        if (i > 0) {
+            const size_t previous_length = pointers[i] - pointers[i - 1];
+            const size_t prefix_length = CommonPrefixLength(pointers[i - 1], previous_length, str, length);
+            total_prefix_length += prefix_length;
+            if (prefix_length == previous_length || (prefix_length < length && pointers[i - 1][prefix_length] < str[prefix_length])) {
+                n_ordered++;
+            }
+        }
+    }
+
+    const size_t total_bytes = pointers[n] - pointers[0];
+    size_t ascii_bytes = 0;
+    for (size_t byte = 0; byte < 256; byte++) {
+        const uint64_t count = uint64_t{byte_counts[0][byte]} + byte_counts[1][byte] + byte_counts[2][byte] + byte_counts[3][byte];
+        if (count > 0) {
+            const double p = static_cast<double>(count) / static_cast<double>(total_bytes);
+            profile.byte_entropy -= p * std::log2(p);
+        }
+        if (byte < 128) {
+            ascii_bytes += count;
+        }
+    }
+
+    std::vector<uint64_t> counts;
+    for (const auto &[hash, count]: frequent) {
+        counts.push_back(count);
+    }
+    std::sort(counts.begin(), counts.end(), std::greater<>());
+    uint64_t top_k_count = 0;
+    for (size_t i = 0; i < std::min(counts.size(), PROFILE_TOP_K); i++) {
+        top_k_count += counts[i];
+    }
+
+    profile.distinct_count = n == 0 ? 0.0 : std::min(distinct.Estimate(), static_cast<double>(n));
+    profile.top_k_share = n == 0 ? 0.0 : static_cast<double>(top_k_count) / static_cast<double>(n);
+    profile.ascii_fraction = total_bytes == 0 ? 1.0 : static_cast<double>(ascii_bytes) / static_cast<double>(total_bytes);
+    profile.sortedness = n < 2 ? 1.0 : static_cast<double>(n_ordered) / static_cast<double>(n - 1);
+    profile.avg_common_prefix = n < 2 ? 0.0 : static_cast<double>(total_prefix_length) / static_cast<double>(n - 1);
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    profile.profile_time_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return profile;
+}
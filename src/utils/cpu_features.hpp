@@ -0,0 +1,32 @@
+#pragma once
+
+// Kernels for instruction sets beyond the baseline are compiled with target attributes next to their portable
+// fallback and chosen at runtime, so they run without building the benchmark for the machine it runs on
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2,bmi2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,bmi2")))
+#endif
+
+class CpuFeatures {
+public:
+    // AVX2 together with BMI2, which came with it
+    static bool HasAvx2() {
+#if defined(CPU_FEATURES_X86)
+        static const bool has_avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"));
+        return has_avx2;
+#else
+        return false;
+#endif
+    }
+
+    static bool HasAvx512() {
+#if defined(CPU_FEATURES_X86)
+        static const bool has_avx512 = HasAvx2() && __builtin_cpu_supports("avx512f");
+        return has_avx512;
+#else
+        return false;
+#endif
+    }
+};
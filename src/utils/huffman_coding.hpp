@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+// Writes values of up to 32 bits to a byte stream, least significant bit first
+class BitWriter {
+public:
+    // bytes after the end of the stream, so a reader can always load a full word
+    static constexpr size_t PADDING = 8;
+
+    inline void Write(const uint64_t value, const uint8_t n_bits) {
+        buffer_ |= value << n_buffered_;
+        n_buffered_ += n_bits;
+        while (n_buffered_ >= 8) {
+            bytes_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            n_buffered_ -= 8;
+        }
+        bit_count_ += n_bits;
+    }
+
+    [[nodiscard]] size_t BitCount() const {
+        return bit_count_;
+    }
+
+    // flushes the last partial byte and returns the stream followed by PADDING bytes
+    std::vector<uint8_t> Finish() {
+        if (n_buffered_ > 0) {
+            bytes_.push_back(static_cast<uint8_t>(buffer_));
+        }
+        bytes_.resize(bytes_.size() + PADDING, 0);
+        buffer_ = 0;
+        n_buffered_ = 0;
+        return std::move(bytes_);
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+    uint64_t buffer_{0};
+    uint8_t n_buffered_{0};
+    size_t bit_count_{0};
+};
+
+// at least 56 valid bits starting at bit_position of a stream written by BitWriter
+inline uint64_t PeekBits(const uint8_t *data, const size_t bit_position) {
+    uint64_t word;
+    std::memcpy(&word, data + bit_position / 8, sizeof(word));
+    return word >> (bit_position % 8);
+}
+
+// Canonical Huffman code with a length limit, decoded with a single lookup in a table of 2^max_code_length entries
+class HuffmanCode {
+public:
+    // symbols with frequency 0 get no code
+    void Build(const std::vector<uint64_t> &frequencies, const uint8_t max_code_length) {
+        max_code_length_ = max_code_length;
+        const size_t n_symbols = frequencies.size();
+        code_lengths_.assign(n_symbols, 0);
+        codes_.assign(n_symbols, 0);
+
+        ComputeCodeLengths(frequencies);
+        LimitCodeLengths(frequencies);
+        AssignCanonicalCodes();
+    }
+
+    inline void Encode(BitWriter &writer, const uint32_t symbol) const {
+        writer.Write(codes_[symbol], code_lengths_[symbol]);
+    }
+
+    inline uint32_t Decode(const uint8_t *data, size_t &bit_position) const {
+        const DecodeEntry entry = decode_table_[PeekBits(data, bit_position) & decode_mask_];
+        bit_position += entry.length;
+        return entry.symbol;
+    }
+
+    // the code of symbol as it is written, its first bit is the least significant one
+    [[nodiscard]] uint32_t Code(const uint32_t symbol) const {
+        return codes_[symbol];
+    }
+
+    // 0 for symbols without a code
+    [[nodiscard]] uint8_t CodeLength(const uint32_t symbol) const {
+        return code_lengths_[symbol];
+    }
+
+    // the code lengths of all symbols, 4 bits each, are enough to rebuild the code
+    [[nodiscard]] size_t SizeInBytes() const {
+        return (code_lengths_.size() + 1) / 2;
+    }
+
+private:
+    struct DecodeEntry {
+        uint16_t symbol;
+        uint8_t length;
+    };
+
+    void ComputeCodeLengths(const std::vector<uint64_t> &frequencies) {
+        struct Node {
+            uint64_t frequency;
+            size_t parent;
+        };
+        std::vector<Node> nodes;
+        using QueueEntry = std::pair<uint64_t, size_t>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+        for (size_t symbol = 0; symbol < frequencies.size(); symbol++) {
+            nodes.push_back({frequencies[symbol], SIZE_MAX});
+            if (frequencies[symbol] > 0) {
+                queue.emplace(frequencies[symbol], symbol);
+            }
+        }
+        if (queue.size() == 1) {
+            // a single symbol still needs one bit to be decodable
+            code_lengths_[queue.top().second] = 1;
+            return;
+        }
+
+        while (queue.size() > 1) {
+            const auto [first_frequency, first] = queue.top();
+            queue.pop();
+            const auto [second_frequency, second] = queue.top();
+            queue.pop();
+            const size_t parent = nodes.size();
+            nodes.push_back({first_frequency + second_frequency, SIZE_MAX});
+            nodes[first].parent = parent;
+            nodes[second].parent = parent;
+            queue.emplace(first_frequency + second_frequency, parent);
+        }
+
+        for (size_t symbol = 0; symbol < frequencies.size(); symbol++) {
+            if (frequencies[symbol] == 0) continue;
+            uint8_t depth = 0;
+            for (size_t node = symbol; nodes[node].parent != SIZE_MAX; node = nodes[node].parent) {
+                depth++;
+            }
+            code_lengths_[symbol] = depth;
+        }
+    }
+
+    // cuts codes longer than the limit and lengthens the codes of the rarest symbols until the code is decodable again
+    void LimitCodeLengths(const std::vector<uint64_t> &frequencies) {
+        const uint64_t kraft_limit = uint64_t{1} << max_code_length_;
+        uint64_t kraft_sum = 0;
+        for (auto &length: code_lengths_) {
+            length = std::min(length, max_code_length_);
+            if (length > 0) kraft_sum += uint64_t{1} << (max_code_length_ - length);
+        }
+        if (kraft_sum <= kraft_limit) return;
+
+        std::vector<size_t> by_frequency(code_lengths_.size());
+        std::iota(by_frequency.begin(), by_frequency.end(), 0);
+        std::sort(by_frequency.begin(), by_frequency.end(), [&](const size_t a, const size_t b) {
+            return frequencies[a] < frequencies[b];
+        });
+        while (kraft_sum > kraft_limit) {
+            for (const size_t symbol: by_frequency) {
+                uint8_t &length = code_lengths_[symbol];
+                if (length == 0 || length == max_code_length_) continue;
+                kraft_sum -= uint64_t{1} << (max_code_length_ - length - 1);
+                length++;
+                if (kraft_sum <= kraft_limit) break;
+            }
+        }
+    }
+
+    void AssignCanonicalCodes() {
+        std::vector<size_t> order;
+        for (size_t symbol = 0; symbol < code_lengths_.size(); symbol++) {
+            if (code_lengths_[symbol] > 0) order.push_back(symbol);
+        }
+        std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+            return code_lengths_[a] != code_lengths_[b] ? code_lengths_[a] < code_lengths_[b] : a < b;
+        });
+
+        decode_mask_ = (uint64_t{1} << max_code_length_) - 1;
+        decode_table_.assign(size_t{1} << max_code_length_, DecodeEntry{0, 0});
+
+        uint32_t code = 0;
+        uint8_t previous_length = 0;
+        for (const size_t symbol: order) {
+            const uint8_t length = code_lengths_[symbol];
+            code <<= length - previous_length;
+            previous_length = length;
+
+            // the stream is read least significant bit first, so codes are written reversed
+            uint32_t reversed = 0;
+            for (uint8_t bit = 0; bit < length; bit++) {
+                reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+            }
+            codes_[symbol] = reversed;
+            for (size_t index = reversed; index < decode_table_.size(); index += size_t{1} << length) {
+                decode_table_[index] = {static_cast<uint16_t>(symbol), length};
+            }
+            code++;
+        }
+    }
+
+    uint8_t max_code_length_{0};
+    std::vector<uint8_t> code_lengths_;
+    std::vector<uint32_t> codes_;
+    std::vector<DecodeEntry> decode_table_;
+    uint64_t decode_mask_{0};
+};
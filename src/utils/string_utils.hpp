@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Length of the longest common prefix of a and b, comparing 16 bytes at a time with SSE2
+inline size_t CommonPrefixLength(const uint8_t *a, const size_t a_length, const uint8_t *b, const size_t b_length) {
+    const size_t max_length = std::min(a_length, b_length);
+    size_t length = 0;
+#if defined(__SSE2__)
+    for (; length + 16 <= max_length; length += 16) {
+        const __m128i a_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + length));
+        const __m128i b_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + length));
+        const auto equal_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a_bytes, b_bytes)));
+        if (equal_mask != 0xFFFF) {
+            return length + __builtin_ctz(~equal_mask);
+        }
+    }
+#endif
+    while (length < max_length && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+// Length of the longest common suffix of a and b
+inline size_t CommonSuffixLength(const uint8_t *a, const size_t a_length, const uint8_t *b, const size_t b_length) {
+    const size_t max_length = std::min(a_length, b_length);
+    size_t length = 0;
+    while (length < max_length && a[a_length - 1 - length] == b[b_length - 1 - length]) {
+        length++;
+    }
+    return length;
+}
+
+// Sorts values on up to n_threads threads, each with at least min_chunk values: every thread sorts a chunk, then
+// neighbouring sorted chunks are merged in rounds, the merges of a round in parallel
+template <typename T, typename Compare>
+void ParallelSort(std::vector<T> &values, const Compare compare, const size_t n_threads, const size_t min_chunk) {
+    const size_t n_chunks = std::max<size_t>(std::min(n_threads, values.size() / std::max<size_t>(min_chunk, 1)), 1);
+    if (n_chunks == 1) {
+        std::sort(values.begin(), values.end(), compare);
+        return;
+    }
+    std::vector<size_t> bounds(n_chunks + 1);
+    for (size_t chunk = 0; chunk <= n_chunks; chunk++) {
+        bounds[chunk] = values.size() * chunk / n_chunks;
+    }
+    std::vector<std::thread> threads;
+    for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+        threads.emplace_back([&, chunk]() {
+            std::sort(values.begin() + bounds[chunk], values.begin() + bounds[chunk + 1], compare);
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (size_t width = 1; width < n_chunks; width *= 2) {
+        threads.clear();
+        for (size_t chunk = 0; chunk + width < n_chunks; chunk += 2 * width) {
+            const size_t begin = bounds[chunk];
+            const size_t middle = bounds[chunk + width];
+            const size_t end = bounds[std::min(chunk + 2 * width, n_chunks)];
+            threads.emplace_back([&values, compare, begin, middle, end]() {
+                std::inplace_merge(values.begin() + begin, values.begin() + middle, values.begin() + end, compare);
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+}
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "huffman_coding.hpp"
+#include "../models/benchmark_config.hpp"
+
+// Suffix array construction by induced sorting (SA-IS), linear in the length of the text. A suffix that is a prefix of
+// another one sorts first, as if the text ended with a sentinel smaller than every symbol
+class SuffixArray {
+public:
+    static std::vector<int32_t> Build(const uint8_t *text, const size_t n) {
+        std::vector<int32_t> symbols(text, text + n);
+        return InducedSort(symbols, 255);
+    }
+
+private:
+    static constexpr size_t NAIVE_THRESHOLD = 32;
+
+    // short texts, and the reduced texts of the recursion once they are short, are sorted by comparing suffixes
+    static std::vector<int32_t> SortNaive(const std::vector<int32_t> &s) {
+        const auto n = static_cast<int32_t>(s.size());
+        std::vector<int32_t> sa(n);
+        std::iota(sa.begin(), sa.end(), 0);
+        std::sort(sa.begin(), sa.end(), [&](int32_t l, int32_t r) {
+            if (l == r) return false;
+            while (l < n && r < n) {
+                if (s[l] != s[r]) return s[l] < s[r];
+                l++;
+                r++;
+            }
+            return l == n;
+        });
+        return sa;
+    }
+
+    // s holds symbols in [0, upper]
+    static std::vector<int32_t> InducedSort(const std::vector<int32_t> &s, const int32_t upper) {
+        const auto n = static_cast<int32_t>(s.size());
+        if (n < static_cast<int32_t>(NAIVE_THRESHOLD)) {
+            return SortNaive(s);
+        }
+
+        // a suffix is S-type if it is smaller than the next one, L-type otherwise
+        std::vector<int32_t> sa(n);
+        std::vector<uint8_t> is_s(n, false);
+        for (int32_t i = n - 2; i >= 0; i--) {
+            is_s[i] = s[i] == s[i + 1] ? is_s[i + 1] : s[i] < s[i + 1];
+        }
+        // bucket starts of the L-type and S-type suffixes of every symbol
+        std::vector<int32_t> l_starts(upper + 2, 0), s_starts(upper + 1, 0);
+        for (int32_t i = 0; i < n; i++) {
+            if (!is_s[i]) {
+                s_starts[s[i]]++;
+            } else {
+                l_starts[s[i] + 1]++;
+            }
+        }
+        for (int32_t c = 0; c <= upper; c++) {
+            s_starts[c] += l_starts[c];
+            l_starts[c + 1] += s_starts[c];
+        }
+
+        std::vector<int32_t> bucket(upper + 1);
+        const auto induce = [&](const std::vector<int32_t> &lms) {
+            std::fill(sa.begin(), sa.end(), -1);
+            std::copy(s_starts.begin(), s_starts.end(), bucket.begin());
+            for (const int32_t d: lms) {
+                if (d != n) {
+                    sa[bucket[s[d]]++] = d;
+                }
+            }
+            std::copy(l_starts.begin(), l_starts.end() - 1, bucket.begin());
+            sa[bucket[s[n - 1]]++] = n - 1;
+            for (int32_t i = 0; i < n; i++) {
+                const int32_t v = sa[i];
+                if (v >= 1 && !is_s[v - 1]) {
+                    sa[bucket[s[v - 1]]++] = v - 1;
+                }
+            }
+            std::copy(l_starts.begin(), l_starts.end() - 1, bucket.begin());
+            for (int32_t i = n - 1; i >= 0; i--) {
+                const int32_t v = sa[i];
+                if (v >= 1 && is_s[v - 1]) {
+                    sa[--bucket[s[v - 1] + 1]] = v - 1;
+                }
+            }
+        };
+
+        // the leftmost S-type suffixes (LMS) of runs, sorted by their LMS substrings first
+        std::vector<int32_t> lms_index(n + 1, -1);
+        std::vector<int32_t> lms;
+        for (int32_t i = 1; i < n; i++) {
+            if (!is_s[i - 1] && is_s[i]) {
+                lms_index[i] = static_cast<int32_t>(lms.size());
+                lms.push_back(i);
+            }
+        }
+        const auto m = static_cast<int32_t>(lms.size());
+        induce(lms);
+        if (m == 0) {
+            return sa;
+        }
+
+        // name the LMS substrings in sorted order, equal ones get the same name, and sort the reduced text they form
+        std::vector<int32_t> sorted_lms;
+        sorted_lms.reserve(m);
+        for (const int32_t v: sa) {
+            if (lms_index[v] != -1) {
+                sorted_lms.push_back(v);
+            }
+        }
+        std::vector<int32_t> reduced(m);
+        int32_t reduced_upper = 0;
+        reduced[lms_index[sorted_lms[0]]] = 0;
+        for (int32_t i = 1; i < m; i++) {
+            int32_t l = sorted_lms[i - 1];
+            int32_t r = sorted_lms[i];
+            const int32_t end_l = lms_index[l] + 1 < m ? lms[lms_index[l] + 1] : n;
+            const int32_t end_r = lms_index[r] + 1 < m ? lms[lms_index[r] + 1] : n;
+            bool same = end_l - l == end_r - r;
+            if (same) {
+                while (l < end_l && s[l] == s[r]) {
+                    l++;
+                    r++;
+                }
+                same = l != n && s[l] == s[r];
+            }
+            if (!same) {
+                reduced_upper++;
+            }
+            reduced[lms_index[sorted_lms[i]]] = reduced_upper;
+        }
+        const auto reduced_sa = InducedSort(reduced, reduced_upper);
+        for (int32_t i = 0; i < m; i++) {
+            sorted_lms[i] = lms[reduced_sa[i]];
+        }
+        induce(sorted_lms);
+        return sa;
+    }
+};
+
+// Bit vector with constant time rank: the number of ones before every block of 512 bits, the rest is counted in the
+// words of the block
+class RankBitVector {
+public:
+    void Build(std::vector<uint64_t> words, const size_t n_bits) {
+        words_ = std::move(words);
+        words_.resize(n_bits / 64 + 1, 0);
+        block_ranks_.assign(words_.size() / WORDS_PER_BLOCK + 1, 0);
+        uint32_t rank = 0;
+        for (size_t word = 0; word < words_.size(); word++) {
+            if (word % WORDS_PER_BLOCK == 0) {
+                block_ranks_[word / WORDS_PER_BLOCK] = rank;
+            }
+            rank += __builtin_popcountll(words_[word]);
+        }
+        n_bits_ = n_bits;
+    }
+
+    [[nodiscard]] bool Get(const size_t i) const {
+        return words_[i / 64] >> (i % 64) & 1;
+    }
+
+    // the number of ones in [0, i)
+    [[nodiscard]] size_t Rank(const size_t i) const {
+        size_t rank = block_ranks_[i / 512];
+        for (size_t word = i / 512 * WORDS_PER_BLOCK; word < i / 64; word++) {
+            rank += __builtin_popcountll(words_[word]);
+        }
+        if (i % 64 != 0) {
+            rank += __builtin_popcountll(words_[i / 64] << (64 - i % 64));
+        }
+        return rank;
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        return (n_bits_ + 7) / 8 + block_ranks_.size() * sizeof(uint32_t);
+    }
+
+    void Clear() {
+        words_.clear();
+        block_ranks_.clear();
+        n_bits_ = 0;
+    }
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+
+    std::vector<uint64_t> words_;
+    std::vector<uint32_t> block_ranks_;
+    size_t n_bits_{0};
+};
+
+// Wavelet tree shaped like the Huffman code of the symbols of a byte sequence: a node holds one bit per symbol below it,
+// the next bit of its code, so the tree takes about as many bits as the sequence Huffman coded. Access and rank walk
+// from the root to the leaf of a symbol with a rank in the bit vector of every node on the way
+class HuffmanWaveletTree {
+public:
+    void Build(const uint8_t *symbols, const size_t n) {
+        std::vector<uint64_t> frequencies(256, 0);
+        for (size_t i = 0; i < n; i++) {
+            frequencies[symbols[i]]++;
+        }
+        code_.Build(frequencies, HUFFMAN_MAX_CODE_LENGTH);
+
+        // the inner nodes of the code tree, a child below 0 is the leaf of symbol -1 - child and 0 is none, as the root
+        // is no child
+        nodes_.assign(1, Node{});
+        for (uint32_t symbol = 0; symbol < 256; symbol++) {
+            size_t node = 0;
+            for (uint8_t depth = 0; depth < code_.CodeLength(symbol); depth++) {
+                const uint32_t bit = code_.Code(symbol) >> depth & 1;
+                if (depth + 1 == code_.CodeLength(symbol)) {
+                    nodes_[node].children[bit] = -1 - static_cast<int32_t>(symbol);
+                } else {
+                    if (nodes_[node].children[bit] == 0) {
+                        nodes_[node].children[bit] = static_cast<int32_t>(nodes_.size());
+                        nodes_.emplace_back();
+                    }
+                    node = nodes_[node].children[bit];
+                }
+            }
+        }
+
+        std::vector<std::vector<uint64_t>> words(nodes_.size());
+        std::vector<size_t> n_bits(nodes_.size(), 0);
+        for (size_t i = 0; i < n; i++) {
+            size_t node = 0;
+            for (uint8_t depth = 0; depth < code_.CodeLength(symbols[i]); depth++) {
+                const uint32_t bit = code_.Code(symbols[i]) >> depth & 1;
+                if (n_bits[node] % 64 == 0) {
+                    words[node].push_back(0);
+                }
+                words[node].back() |= uint64_t{bit} << (n_bits[node] % 64);
+                n_bits[node]++;
+                node = nodes_[node].children[bit];
+            }
+        }
+        for (size_t node = 0; node < nodes_.size(); node++) {
+            nodes_[node].bits.Build(std::move(words[node]), n_bits[node]);
+        }
+    }
+
+    // the symbol at i, and in rank the number of times it occurs before i
+    inline uint8_t AccessRank(size_t i, size_t &rank) const {
+        int32_t node = 0;
+        while (node >= 0) {
+            const Node &inner = nodes_[node];
+            const bool bit = inner.bits.Get(i);
+            const size_t ones = inner.bits.Rank(i);
+            i = bit ? ones : i - ones;
+            node = inner.children[bit];
+        }
+        rank = i;
+        return static_cast<uint8_t>(-1 - node);
+    }
+
+    // the whole sequence, every node is read front to back
+    void Extract(uint8_t *out, const size_t n) const {
+        std::vector<size_t> positions(nodes_.size(), 0);
+        for (size_t i = 0; i < n; i++) {
+            int32_t node = 0;
+            while (node >= 0) {
+                node = nodes_[node].children[nodes_[node].bits.Get(positions[node]++)];
+            }
+            out[i] = static_cast<uint8_t>(-1 - node);
+        }
+    }
+
+    // the number of times symbol occurs before i, symbol has to occur in the sequence
+    [[nodiscard]] inline size_t Rank(const uint8_t symbol, size_t i) const {
+        size_t node = 0;
+        for (uint8_t depth = 0; depth < code_.CodeLength(symbol); depth++) {
+            const uint32_t bit = code_.Code(symbol) >> depth & 1;
+            const size_t ones = nodes_[node].bits.Rank(i);
+            i = bit ? ones : i - ones;
+            node = nodes_[node].children[bit];
+        }
+        return i;
+    }
+
+    // the code lengths are enough to rebuild the shape of the tree
+    [[nodiscard]] size_t SizeInBytes() const {
+        size_t size = code_.SizeInBytes();
+        for (const Node &node: nodes_) {
+            size += node.bits.SizeInBytes();
+        }
+        return size;
+    }
+
+    void Clear() {
+        nodes_.clear();
+    }
+
+private:
+    struct Node {
+        int32_t children[2] = {0, 0};
+        RankBitVector bits;
+    };
+
+    HuffmanCode code_;
+    std::vector<Node> nodes_;
+};
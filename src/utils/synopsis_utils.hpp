@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "../models/benchmark_config.hpp"
+#include "../../external/robin_hood/robin_hood.h"
+
+// Per-vector synopses of a row group to skip vectors in predicate scans: the first bytes of the smallest and largest
+// string (a zone map), the number of distinct strings and a split block bloom filter of the string hashes. A block is
+// 256 bits in 8 words, a key picks one block and sets one bit in each of its words, so a lookup touches one cache line.
+// The filter of a vector has SYNOPSIS_BLOOM_BITS_PER_KEY bits per distinct string, rounded up to a power of two blocks
+class VectorSynopses {
+public:
+    void Build(const StringCollector &collector) {
+        const auto pointers = collector.GetPointers();
+        const size_t n_vectors = (collector.Size() + VECTOR_SIZE - 1) / VECTOR_SIZE;
+        vectors_.assign(n_vectors, {});
+        blocks_.clear();
+
+        // the distinct hashes of a vector, found with a linear probing set of twice as many slots as rows
+        std::vector<uint64_t> hashes;
+        hashes.reserve(VECTOR_SIZE);
+        std::vector<uint64_t> slots(2 * VECTOR_SIZE);
+        for (size_t vector_idx = 0; vector_idx < n_vectors; vector_idx++) {
+            const size_t start = vector_idx * VECTOR_SIZE;
+            const size_t end = std::min(start + VECTOR_SIZE, collector.Size());
+            Synopsis &synopsis = vectors_[vector_idx];
+            synopsis.min_prefix = UINT64_MAX;
+            hashes.clear();
+            std::fill(slots.begin(), slots.end(), EMPTY_SLOT);
+            for (size_t row = start; row < end; row++) {
+                const std::string_view str(reinterpret_cast<const char *>(pointers[row]), pointers[row + 1] - pointers[row]);
+                const uint64_t prefix = Prefix(str);
+                synopsis.min_prefix = std::min(synopsis.min_prefix, prefix);
+                synopsis.max_prefix = std::max(synopsis.max_prefix, prefix);
+                const uint64_t hash = Hash(str);
+                size_t slot = hash & (slots.size() - 1);
+                while (slots[slot] != EMPTY_SLOT && slots[slot] != hash) {
+                    slot = (slot + 1) & (slots.size() - 1);
+                }
+                if (slots[slot] == EMPTY_SLOT) {
+                    slots[slot] = hash;
+                    hashes.push_back(hash);
+                }
+            }
+            synopsis.n_distinct = static_cast<uint32_t>(hashes.size());
+
+            size_t n_blocks = 1;
+            while (n_blocks * BLOCK_BITS < hashes.size() * SYNOPSIS_BLOOM_BITS_PER_KEY) {
+                n_blocks *= 2;
+            }
+            synopsis.first_block = static_cast<uint32_t>(blocks_.size());
+            synopsis.n_blocks = static_cast<uint32_t>(n_blocks);
+            blocks_.resize(blocks_.size() + n_blocks, Block{});
+            for (const uint64_t hash: hashes) {
+                Block &block = blocks_[synopsis.first_block + BlockIndex(hash, n_blocks)];
+                const Block mask = Mask(hash);
+                for (size_t word = 0; word < BLOCK_WORDS; word++) {
+                    block.words[word] |= mask.words[word];
+                }
+            }
+        }
+    }
+
+    // false if no string of the vector equals value
+    [[nodiscard]] bool MayContain(const size_t vector_idx, const std::string_view value) const {
+        const Synopsis &synopsis = vectors_[vector_idx];
+        const uint64_t prefix = Prefix(value);
+        if (prefix < synopsis.min_prefix || prefix > synopsis.max_prefix) {
+            return false;
+        }
+        const uint64_t hash = Hash(value);
+        const Block &block = blocks_[synopsis.first_block + BlockIndex(hash, synopsis.n_blocks)];
+        const Block mask = Mask(hash);
+        for (size_t word = 0; word < BLOCK_WORDS; word++) {
+            if ((block.words[word] & mask.words[word]) != mask.words[word]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // false if no string of the vector satisfies low <= string <= high. The prefixes order like the strings, up to ties
+    [[nodiscard]] bool MayContainRange(const size_t vector_idx, const std::string_view low, const std::string_view high) const {
+        const Synopsis &synopsis = vectors_[vector_idx];
+        return Prefix(low) <= synopsis.max_prefix && Prefix(high) >= synopsis.min_prefix;
+    }
+
+    [[nodiscard]] size_t NumVectors() const {
+        return vectors_.size();
+    }
+
+    [[nodiscard]] uint64_t NumDistinct() const {
+        uint64_t n_distinct = 0;
+        for (const Synopsis &synopsis: vectors_) {
+            n_distinct += synopsis.n_distinct;
+        }
+        return n_distinct;
+    }
+
+    [[nodiscard]] size_t SizeInBytes() const {
+        return vectors_.size() * sizeof(Synopsis) + blocks_.size() * sizeof(Block);
+    }
+
+    void Clear() {
+        vectors_.clear();
+        blocks_.clear();
+    }
+
+private:
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t BLOCK_BITS = BLOCK_WORDS * 32;
+    // a string whose hash is this is counted as a distinct string of its own, rare enough not to matter
+    static constexpr uint64_t EMPTY_SLOT = 0;
+
+    struct Synopsis {
+        uint64_t min_prefix;
+        uint64_t max_prefix;
+        uint32_t n_distinct;
+        uint32_t first_block;
+        uint32_t n_blocks;
+    };
+
+    struct alignas(32) Block {
+        uint32_t words[BLOCK_WORDS];
+    };
+
+    // the first 8 bytes big-endian and zero padded, so prefixes compare like the strings they start
+    static uint64_t Prefix(const std::string_view str) {
+        uint8_t bytes[8] = {};
+        std::memcpy(bytes, str.data(), std::min<size_t>(str.size(), 8));
+        uint64_t prefix;
+        std::memcpy(&prefix, bytes, 8);
+        return __builtin_bswap64(prefix);
+    }
+
+    static uint64_t Hash(const std::string_view str) {
+        return robin_hood::hash_bytes(str.data(), str.size());
+    }
+
+    // the upper half of the hash picks the block, the lower half the bits
+    static size_t BlockIndex(const uint64_t hash, const size_t n_blocks) {
+        return static_cast<size_t>(((hash >> 32) * n_blocks) >> 32);
+    }
+
+    static Block Mask(const uint64_t hash) {
+        // the salts of the split block bloom filter of Parquet
+        static constexpr uint32_t SALTS[BLOCK_WORDS] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        Block mask{};
+        const auto key = static_cast<uint32_t>(hash);
+        for (size_t word = 0; word < BLOCK_WORDS; word++) {
+            mask.words[word] = uint32_t{1} << ((key * SALTS[word]) >> 27);
+        }
+        return mask;
+    }
+
+    std::vector<Synopsis> vectors_;
+    std::vector<Block> blocks_;
+};
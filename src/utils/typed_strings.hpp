@@ -0,0 +1,399 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "cpu_features.hpp"
+
+// Text formats that can be stored as a fixed-width binary value and printed back to exactly the same text. Only the
+// canonical spelling of a value parses (e.g. no leading zeros, fixed-width timestamps), so printing never changes a
+// string
+enum class StringFormat {
+    None,
+    Integer, // -?(0|[1-9][0-9]*), at most 18 digits
+    Decimal, // an integer part as above, a '.' and exactly scale digits, at most 18 digits in total
+    Uuid, // 8-4-4-4-12 hex digits, all lower case or all upper case
+    Timestamp, // YYYY-MM-DD HH:MM:SS with ' ' or 'T' between date and time
+    Date, // YYYY-MM-DD
+    IPv4, // four numbers up to 255 without leading zeros, separated by '.'
+};
+
+// A format and the variant of it the strings use
+struct StringFormatSpec {
+    StringFormat format = StringFormat::None;
+    // digits after the point of a Decimal
+    uint8_t scale = 0;
+    // hex digits of a Uuid in upper case
+    bool uppercase = false;
+    // between date and time of a Timestamp
+    char separator = ' ';
+
+    [[nodiscard]] std::string ToString() const {
+        switch (format) {
+            case StringFormat::None: return "none";
+            case StringFormat::Integer: return "integer";
+            case StringFormat::Decimal: return "decimal(" + std::to_string(scale) + ")";
+            case StringFormat::Uuid: return uppercase ? "uuid_upper" : "uuid";
+            case StringFormat::Timestamp: return separator == 'T' ? "timestamp_iso" : "timestamp";
+            case StringFormat::Date: return "date";
+            case StringFormat::IPv4: return "ipv4";
+        }
+        return "unknown";
+    }
+};
+
+// Parsing and printing of the formats
+class TypedStringUtils {
+public:
+    static constexpr size_t UUID_LENGTH = 36;
+    static constexpr size_t UUID_BYTES = 16;
+    // bit i is set if character i of a UUID is a dash
+    static constexpr uint32_t UUID_DASH_POSITIONS = (1u << 8) | (1u << 13) | (1u << 18) | (1u << 23);
+    static constexpr size_t TIMESTAMP_LENGTH = 19;
+    static constexpr size_t DATE_LENGTH = 10;
+    static constexpr size_t MAX_INTEGER_DIGITS = 18;
+    // longest printed value of any format, a UUID
+    static constexpr size_t MAX_PRINTED_LENGTH = UUID_LENGTH;
+
+    static bool IsDigit(const uint8_t c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static int HexValue(const uint8_t c, const bool uppercase) {
+        if (IsDigit(c)) return c - '0';
+        const uint8_t first = uppercase ? 'A' : 'a';
+        if (c >= first && c < first + 6) return c - first + 10;
+        return -1;
+    }
+
+    // days since 1970-01-01 of a date of the proleptic Gregorian calendar
+    static int64_t DaysFromCivil(int64_t year, const int64_t month, const int64_t day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const int64_t year_of_era = year - era * 400;
+        const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        return era * 146097 + day_of_era - 719468;
+    }
+
+    static void CivilFromDays(int64_t days, int64_t &year, int64_t &month, int64_t &day) {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const int64_t day_of_era = days - era * 146097;
+        const int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        const int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        const int64_t month_index = (5 * day_of_year + 2) / 153;
+        day = day_of_year - (153 * month_index + 2) / 5 + 1;
+        month = month_index < 10 ? month_index + 3 : month_index - 9;
+        year = year_of_era + era * 400 + (month <= 2);
+    }
+
+    static int64_t DaysInMonth(const int64_t year, const int64_t month) {
+        constexpr int64_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return month == 2 && leap ? 29 : days[month - 1];
+    }
+
+    static int64_t Digits(const uint8_t *s, const size_t n) {
+        int64_t value = 0;
+        for (size_t i = 0; i < n; i++) {
+            value = value * 10 + (s[i] - '0');
+        }
+        return value;
+    }
+
+    // digits without a sign or leading zeros, the value is added to value
+    static bool ParseCanonicalDigits(const uint8_t *s, const size_t len, int64_t &value) {
+        if (len == 0 || len > MAX_INTEGER_DIGITS || (s[0] == '0' && len > 1)) return false;
+        for (size_t i = 0; i < len; i++) {
+            if (!IsDigit(s[i])) return false;
+            value = value * 10 + (s[i] - '0');
+        }
+        return true;
+    }
+
+    static bool ParseInteger(const uint8_t *s, const size_t len, int64_t &out) {
+        const bool negative = len > 0 && s[0] == '-';
+        int64_t value = 0;
+        if (!ParseCanonicalDigits(s + negative, len - negative, value) || (negative && value == 0)) return false;
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // number of digits after the '.' of a string that could be a Decimal, -1 if there is no '.'
+    static int DecimalScale(const uint8_t *s, const size_t len) {
+        const void *point = std::memchr(s, '.', len);
+        return point == nullptr ? -1 : static_cast<int>(s + len - static_cast<const uint8_t *>(point) - 1);
+    }
+
+    static bool ParseDecimal(const uint8_t *s, const size_t len, const uint8_t scale, int64_t &out) {
+        const bool negative = len > 0 && s[0] == '-';
+        const size_t integer_digits = len - negative - scale - 1;
+        if (len < negative + scale + 2u || s[negative + integer_digits] != '.' || integer_digits + scale > MAX_INTEGER_DIGITS) {
+            return false;
+        }
+        int64_t value = 0;
+        if (!ParseCanonicalDigits(s + negative, integer_digits, value)) return false;
+        for (size_t i = len - scale; i < len; i++) {
+            if (!IsDigit(s[i])) return false;
+            value = value * 10 + (s[i] - '0');
+        }
+        if (negative && value == 0) return false;
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // the layout of a UUID: hex digits and dashes at 8, 13, 18 and 23. The first 32 bytes are checked at once with AVX2
+    // if the CPU has it
+    static bool ValidateUuid(const uint8_t *s, const bool uppercase) {
+#if defined(CPU_FEATURES_X86)
+        if (CpuFeatures::HasAvx2()) {
+            return ValidateUuidAvx2(s, uppercase);
+        }
+#endif
+        for (size_t i = 0; i < UUID_LENGTH; i++) {
+            const bool is_dash_position = i < 32 && ((UUID_DASH_POSITIONS >> i) & 1);
+            if (is_dash_position ? s[i] != '-' : HexValue(s[i], uppercase) < 0) return false;
+        }
+        return true;
+    }
+
+#if defined(CPU_FEATURES_X86)
+    TARGET_AVX2 static bool ValidateUuidAvx2(const uint8_t *s, const bool uppercase) {
+        const char hex_first = uppercase ? 'A' : 'a';
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+        // bytes are compared as signed, bytes above 127 are negative and fail both ranges
+        const __m256i below_digits = _mm256_cmpgt_epi8(_mm256_set1_epi8('0'), bytes);
+        const __m256i above_digits = _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('9'));
+        const __m256i below_letters = _mm256_cmpgt_epi8(_mm256_set1_epi8(hex_first), bytes);
+        const __m256i above_letters = _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(static_cast<char>(hex_first + 5)));
+        const __m256i not_digit = _mm256_or_si256(below_digits, above_digits);
+        const __m256i not_letter = _mm256_or_si256(below_letters, above_letters);
+        const auto not_hex = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(not_digit, not_letter)));
+        const auto dashes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-'))));
+        if (not_hex != UUID_DASH_POSITIONS || dashes != UUID_DASH_POSITIONS) return false;
+        for (size_t i = 32; i < UUID_LENGTH; i++) {
+            if (HexValue(s[i], uppercase) < 0) return false;
+        }
+        return true;
+    }
+#endif
+
+    static bool ParseUuid(const uint8_t *s, const size_t len, const bool uppercase, uint8_t *out) {
+        if (len != UUID_LENGTH || !ValidateUuid(s, uppercase)) return false;
+        // the characters are valid hex digits now, digits and letters of either case convert without branches
+        const auto nibble = [](const uint8_t c) {
+            return static_cast<uint8_t>((c & 0xF) + 9 * (c >> 6));
+        };
+        size_t pos = 0;
+        for (size_t byte = 0; byte < UUID_BYTES; byte++) {
+            pos += s[pos] == '-';
+            out[byte] = static_cast<uint8_t>(nibble(s[pos]) << 4 | nibble(s[pos + 1]));
+            pos += 2;
+        }
+        return true;
+    }
+
+    // YYYY-MM-DD with a valid month and day, as days since 1970-01-01. The digits and dashes are checked by the caller
+    static bool ParseDateDigits(const uint8_t *s, int64_t &days) {
+        const int64_t year = Digits(s, 4);
+        const int64_t month = Digits(s + 5, 2);
+        const int64_t day = Digits(s + 8, 2);
+        if (month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month)) return false;
+        days = DaysFromCivil(year, month, day);
+        return true;
+    }
+
+    static bool ParseDate(const uint8_t *s, const size_t len, int64_t &out) {
+        if (len != DATE_LENGTH) return false;
+        for (size_t i = 0; i < DATE_LENGTH; i++) {
+            if (i == 4 || i == 7 ? s[i] != '-' : !IsDigit(s[i])) return false;
+        }
+        return ParseDateDigits(s, out);
+    }
+
+    // YYYY-MM-DD?HH:MM:SS as seconds since 1970-01-01 00:00:00. The first 16 bytes are checked at once with SSE2
+    static bool ParseTimestamp(const uint8_t *s, const size_t len, const char separator, int64_t &out) {
+        if (len != TIMESTAMP_LENGTH) return false;
+#if defined(__SSE2__)
+        constexpr uint32_t separator_positions = (1u << 4) | (1u << 7) | (1u << 10) | (1u << 13);
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+        const __m128i expected = _mm_setr_epi8(0, 0, 0, 0, '-', 0, 0, '-', 0, 0, separator, 0, 0, ':', 0, 0);
+        const __m128i not_digit = _mm_or_si128(_mm_cmplt_epi8(bytes, _mm_set1_epi8('0')),
+                                               _mm_cmpgt_epi8(bytes, _mm_set1_epi8('9')));
+        const auto separators_match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, expected)));
+        if (static_cast<uint32_t>(_mm_movemask_epi8(not_digit)) != separator_positions ||
+            (separators_match & separator_positions) != separator_positions) {
+            return false;
+        }
+#else
+        for (size_t i = 0; i < 16; i++) {
+            const char expected = i == 4 || i == 7 ? '-' : i == 10 ? separator : i == 13 ? ':' : 0;
+            if (expected != 0 ? s[i] != expected : !IsDigit(s[i])) return false;
+        }
+#endif
+        if (!IsDigit(s[17]) || !IsDigit(s[18]) || s[16] != ':') return false;
+
+        int64_t days;
+        if (!ParseDateDigits(s, days)) return false;
+        const int64_t hours = Digits(s + 11, 2);
+        const int64_t minutes = Digits(s + 14, 2);
+        const int64_t seconds = Digits(s + 17, 2);
+        if (hours > 23 || minutes > 59 || seconds > 59) return false;
+        out = days * 86400 + hours * 3600 + minutes * 60 + seconds;
+        return true;
+    }
+
+    static bool ParseIPv4(const uint8_t *s, const size_t len, int64_t &out) {
+        if (len < 7 || len > 15) return false;
+        int64_t address = 0;
+        size_t pos = 0;
+        for (int part = 0; part < 4; part++) {
+            size_t end = pos;
+            while (end < len && s[end] != '.') end++;
+            int64_t value = 0;
+            if (end - pos > 3 || !ParseCanonicalDigits(s + pos, end - pos, value) || value > 255) return false;
+            if ((part < 3) != (end < len)) return false;
+            address = address << 8 | value;
+            pos = end + 1;
+        }
+        out = address;
+        return true;
+    }
+
+    // the two digits of every number below 100
+    static const char *DigitPairs() {
+        static const char pairs[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+        return pairs;
+    }
+
+    static void WriteTwoDigits(uint8_t *out, const int64_t value) {
+        std::memcpy(out, DigitPairs() + 2 * value, 2);
+    }
+
+    // the digits of value without leading zeros, returns their number
+    static size_t WriteDigits(uint8_t *out, uint64_t value) {
+        uint8_t buffer[20];
+        size_t pos = sizeof(buffer);
+        while (value >= 100) {
+            pos -= 2;
+            std::memcpy(buffer + pos, DigitPairs() + 2 * (value % 100), 2);
+            value /= 100;
+        }
+        if (value >= 10) {
+            pos -= 2;
+            std::memcpy(buffer + pos, DigitPairs() + 2 * value, 2);
+        } else {
+            buffer[--pos] = static_cast<uint8_t>('0' + value);
+        }
+        std::memcpy(out, buffer + pos, sizeof(buffer) - pos);
+        return sizeof(buffer) - pos;
+    }
+
+    static size_t PrintInteger(const int64_t value, uint8_t *out) {
+        if (value < 0) {
+            out[0] = '-';
+            return 1 + WriteDigits(out + 1, static_cast<uint64_t>(-value));
+        }
+        return WriteDigits(out, static_cast<uint64_t>(value));
+    }
+
+    static size_t PrintDecimal(const int64_t value, const uint8_t scale, uint8_t *out) {
+        size_t pos = 0;
+        if (value < 0) {
+            out[pos++] = '-';
+        }
+        uint64_t magnitude = value < 0 ? static_cast<uint64_t>(-value) : static_cast<uint64_t>(value);
+        uint64_t divisor = 1;
+        for (uint8_t i = 0; i < scale; i++) {
+            divisor *= 10;
+        }
+        pos += WriteDigits(out + pos, magnitude / divisor);
+        out[pos++] = '.';
+        uint64_t fraction = magnitude % divisor;
+        for (size_t i = scale; i > 0; i--) {
+            out[pos + i - 1] = static_cast<uint8_t>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        return pos + scale;
+    }
+
+    static size_t PrintUuid(const uint8_t *bytes, const bool uppercase, uint8_t *out) {
+        const char *hex = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+        size_t pos = 0;
+        for (size_t byte = 0; byte < UUID_BYTES; byte++) {
+            if (byte == 4 || byte == 6 || byte == 8 || byte == 10) {
+                out[pos++] = '-';
+            }
+            out[pos++] = hex[bytes[byte] >> 4];
+            out[pos++] = hex[bytes[byte] & 0xF];
+        }
+        return UUID_LENGTH;
+    }
+
+    static size_t PrintDate(const int64_t days, uint8_t *out) {
+        int64_t year, month, day;
+        CivilFromDays(days, year, month, day);
+        WriteTwoDigits(out, year / 100);
+        WriteTwoDigits(out + 2, year % 100);
+        out[4] = '-';
+        WriteTwoDigits(out + 5, month);
+        out[7] = '-';
+        WriteTwoDigits(out + 8, day);
+        return DATE_LENGTH;
+    }
+
+    static size_t PrintTimestamp(const int64_t seconds, const char separator, uint8_t *out) {
+        // floor division, so timestamps before 1970 get a positive time of day
+        const int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+        const int64_t time_of_day = seconds - days * 86400;
+        PrintDate(days, out);
+        out[10] = static_cast<uint8_t>(separator);
+        WriteTwoDigits(out + 11, time_of_day / 3600);
+        out[13] = ':';
+        WriteTwoDigits(out + 14, time_of_day / 60 % 60);
+        out[16] = ':';
+        WriteTwoDigits(out + 17, time_of_day % 60);
+        return TIMESTAMP_LENGTH;
+    }
+
+    static size_t PrintIPv4(const int64_t address, uint8_t *out) {
+        size_t pos = 0;
+        for (int part = 3; part >= 0; part--) {
+            pos += WriteDigits(out + pos, (address >> (8 * part)) & 0xFF);
+            if (part > 0) {
+                out[pos++] = '.';
+            }
+        }
+        return pos;
+    }
+
+    // the value of a string in any format but Uuid, false if the string is not in the format
+    static bool ParseValue(const StringFormatSpec &spec, const uint8_t *s, const size_t len, int64_t &out) {
+        switch (spec.format) {
+            case StringFormat::Integer: return ParseInteger(s, len, out);
+            case StringFormat::Decimal: return ParseDecimal(s, len, spec.scale, out);
+            case StringFormat::Timestamp: return ParseTimestamp(s, len, spec.separator, out);
+            case StringFormat::Date: return ParseDate(s, len, out);
+            case StringFormat::IPv4: return ParseIPv4(s, len, out);
+            default: return false;
+        }
+    }
+
+    static size_t PrintValue(const StringFormatSpec &spec, const int64_t value, uint8_t *out) {
+        switch (spec.format) {
+            case StringFormat::Integer: return PrintInteger(value, out);
+            case StringFormat::Decimal: return PrintDecimal(value, spec.scale, out);
+            case StringFormat::Timestamp: return PrintTimestamp(value, spec.separator, out);
+            case StringFormat::Date: return PrintDate(value, out);
+            case StringFormat::IPv4: return PrintIPv4(value, out);
+            default: return 0;
+        }
+    }
+};